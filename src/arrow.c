@@ -0,0 +1,362 @@
+/*** arrow.c -- export read batches through the Arrow C data interface
+ *
+ * Copyright (C) 2014-2016 Sebastian Freundt
+ *
+ * Author:  Sebastian Freundt <freundt@ga-group.nl>
+ *
+ * This file is part of cotse.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the author nor the names of any contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+#if defined HAVE_CONFIG_H
+# include "config.h"
+#endif	/* HAVE_CONFIG_H */
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include "cotse.h"
+#include "arrow.h"
+#include "nifty.h"
+
+/* private parts of exported arrays, children are stored behind CHP */
+struct apriv_s {
+	const void *bufs[3U];
+	/* memory owned by the array, if any */
+	void *own;
+	struct ArrowArray dict;
+	struct ArrowArray *chp[];
+};
+
+/* private parts of exported schemas, children are stored behind CHP */
+struct spriv_s {
+	char *name;
+	char *meta;
+	struct ArrowSchema dict;
+	struct ArrowSchema *chp[];
+};
+
+
+static void
+_arr_free(struct ArrowArray *a)
+{
+	struct apriv_s *p = a->private_data;
+
+	/* children that haven't been moved out go with us */
+	for (int64_t i = 0; i < a->n_children; i++) {
+		if (a->children[i]->release != NULL) {
+			a->children[i]->release(a->children[i]);
+		}
+	}
+	if (a->dictionary != NULL && a->dictionary->release != NULL) {
+		a->dictionary->release(a->dictionary);
+	}
+	free(p->own);
+	free(p);
+	a->release = NULL;
+	return;
+}
+
+static int
+_arr_init(struct ArrowArray *a, size_t len, size_t nbuf, size_t nch)
+{
+	struct apriv_s *p;
+
+	p = calloc(1U, sizeof(*p) + nch * (sizeof(*p->chp) + sizeof(*a)));
+	if (UNLIKELY(p == NULL)) {
+		return -1;
+	}
+	for (size_t i = 0U; i < nch; i++) {
+		p->chp[i] = (struct ArrowArray*)(p->chp + nch) + i;
+	}
+	*a = (struct ArrowArray){
+		.length = len,
+		.n_buffers = nbuf,
+		.n_children = nch,
+		.buffers = p->bufs,
+		.children = nch ? p->chp : NULL,
+		.release = _arr_free,
+		.private_data = p,
+	};
+	return 0;
+}
+
+static void
+_sch_free(struct ArrowSchema *s)
+{
+	struct spriv_s *p = s->private_data;
+
+	for (int64_t i = 0; i < s->n_children; i++) {
+		if (s->children[i]->release != NULL) {
+			s->children[i]->release(s->children[i]);
+		}
+	}
+	if (s->dictionary != NULL && s->dictionary->release != NULL) {
+		s->dictionary->release(s->dictionary);
+	}
+	free(p->name);
+	free(p->meta);
+	free(p);
+	s->release = NULL;
+	return;
+}
+
+static int
+_sch_init(struct ArrowSchema *s, const char *fmt, const char *name, size_t nch)
+{
+	struct spriv_s *p;
+
+	p = calloc(1U, sizeof(*p) + nch * (sizeof(*p->chp) + sizeof(*s)));
+	if (UNLIKELY(p == NULL)) {
+		return -1;
+	} else if (UNLIKELY((p->name = strdup(name)) == NULL)) {
+		free(p);
+		return -1;
+	}
+	for (size_t i = 0U; i < nch; i++) {
+		p->chp[i] = (struct ArrowSchema*)(p->chp + nch) + i;
+	}
+	*s = (struct ArrowSchema){
+		.format = fmt,
+		.name = p->name,
+		.n_children = nch,
+		.children = nch ? p->chp : NULL,
+		.release = _sch_free,
+		.private_data = p,
+	};
+	return 0;
+}
+
+static int
+_sch_ext(struct ArrowSchema *s, const char *ext)
+{
+/* mark S as extension type EXT, metadata is a count followed by
+ * length-prefixed keys and values, all in native byte order */
+	static const char key[] = "ARROW:extension:name";
+	const int32_t n = 1;
+	const int32_t kz = sizeof(key) - 1U;
+	const int32_t vz = strlen(ext);
+	struct spriv_s *p = s->private_data;
+	char *m = malloc(3U * sizeof(int32_t) + kz + vz);
+	size_t mi = 0U;
+
+	if (UNLIKELY(m == NULL)) {
+		return -1;
+	}
+	memcpy(m + mi, &n, sizeof(n));
+	mi += sizeof(n);
+	memcpy(m + mi, &kz, sizeof(kz));
+	mi += sizeof(kz);
+	memcpy(m + mi, key, kz);
+	mi += kz;
+	memcpy(m + mi, &vz, sizeof(vz));
+	mi += sizeof(vz);
+	memcpy(m + mi, ext, vz);
+	s->metadata = p->meta = m;
+	return 0;
+}
+
+static int
+_arr_dict(struct ArrowArray *a, cots_ts_t s)
+{
+/* attach utf8 array of all tags of S, indexed by tag, to A
+ * entry 0 is the empty string for untagged rows */
+	struct ArrowArray *d = &((struct apriv_s*)a->private_data)->dict;
+	const char *str;
+	size_t nobs = 0U;
+	size_t z = 0U;
+	int32_t *off;
+	char *dat;
+
+	for (; (str = cots_str(s, nobs + 1U)) != NULL; nobs++) {
+		z += strlen(str);
+	}
+	if (UNLIKELY(z > INT32_MAX)) {
+		return -1;
+	}
+	off = malloc((nobs + 2U) * sizeof(*off) + z);
+	if (UNLIKELY(off == NULL)) {
+		return -1;
+	} else if (UNLIKELY(_arr_init(d, nobs + 1U, 3U, 0U) < 0)) {
+		free(off);
+		return -1;
+	}
+	dat = (char*)(off + nobs + 2U);
+	off[0U] = 0, off[1U] = 0;
+	for (size_t k = 1U; k <= nobs; k++) {
+		const size_t len = strlen(str = cots_str(s, k));
+
+		memcpy(dat + off[k], str, len);
+		off[k + 1U] = off[k] + len;
+	}
+	with (struct apriv_s *p = d->private_data) {
+		p->bufs[1U] = off;
+		p->bufs[2U] = dat;
+		p->own = off;
+	}
+	a->dictionary = d;
+	return 0;
+}
+
+static int
+_sch_dict(struct ArrowSchema *s)
+{
+/* attach utf8 dictionary schema to S */
+	struct ArrowSchema *d = &((struct spriv_s*)s->private_data)->dict;
+
+	if (UNLIKELY(_sch_init(d, "u", "", 0U) < 0)) {
+		return -1;
+	}
+	s->dictionary = d;
+	return 0;
+}
+
+static const char*
+_arrow_fmt(char lo)
+{
+	switch (lo) {
+	case COTS_LO_TIM:
+		return "tsn:";
+	case COTS_LO_PRC:
+		/* bid32 words */
+		return "I";
+	case COTS_LO_QTY:
+		/* bid64 words */
+		return "L";
+	case COTS_LO_FLT:
+		return "f";
+	case COTS_LO_DBL:
+		return "g";
+	case COTS_LO_CNT:
+	case COTS_LO_SIZ:
+		return "L";
+	case COTS_LO_STR:
+		/* dictionary indices */
+		return "l";
+	case COTS_LO_BYT:
+		return "C";
+	default:
+		break;
+	}
+	return NULL;
+}
+
+
+/* public API */
+int
+cots_export_arrow(
+	cots_ts_t s, const struct cots_tsoa_s *tsoa, size_t n,
+	struct ArrowArray *arr, struct ArrowSchema *sch)
+{
+	const size_t nflds = s->nfields;
+	const char *layo = s->layout;
+	size_t nch = 1U;
+
+	for (size_t i = 0U; i < nflds; i++) {
+		if (tsoa->cols[i] == NULL) {
+			/* not projected */
+			continue;
+		} else if (UNLIKELY(_arrow_fmt(layo[i]) == NULL)) {
+			return -1;
+		}
+		nch++;
+	}
+	sch->release = NULL;
+	if (UNLIKELY(_arr_init(arr, n, 1U, nch) < 0)) {
+		return -1;
+	} else if (UNLIKELY(_sch_init(sch, "+s", "", nch) < 0)) {
+		goto err;
+	}
+
+	/* time offsets first */
+	if (UNLIKELY(_arr_init(*arr->children, n, 2U, 0U) < 0)) {
+		goto err;
+	} else if (UNLIKELY(_sch_init(*sch->children, "tsn:", "TIME", 0U))) {
+		goto err;
+	}
+	arr->children[0U]->buffers[1U] = tsoa->toffs;
+
+	for (size_t i = 0U, j = 1U; i < nflds; i++) {
+		struct ArrowArray *a = arr->children[j];
+		struct ArrowSchema *c = sch->children[j];
+		char fn[32U];
+		const char *name = fn;
+
+		if (tsoa->cols[i] == NULL) {
+			continue;
+		} else if (s->fields != NULL && s->fields[i] != NULL) {
+			name = s->fields[i];
+		} else {
+			snprintf(fn, sizeof(fn), "f%zu", i);
+		}
+		if (UNLIKELY(_arr_init(a, n, 2U, 0U) < 0)) {
+			goto err;
+		}
+		with (const char *fmt = _arrow_fmt(layo[i])) {
+			if (UNLIKELY(_sch_init(c, fmt, name, 0U) < 0)) {
+				goto err;
+			}
+		}
+		/* columns are shared, no copying */
+		a->buffers[1U] = tsoa->cols[i];
+		j++;
+
+		switch (layo[i]) {
+		case COTS_LO_PRC:
+			if (UNLIKELY(_sch_ext(c, "cots.bid32") < 0)) {
+				goto err;
+			}
+			break;
+		case COTS_LO_QTY:
+			if (UNLIKELY(_sch_ext(c, "cots.bid64") < 0)) {
+				goto err;
+			}
+			break;
+		case COTS_LO_STR:
+			/* tags index into the obarray */
+			if (UNLIKELY(_arr_dict(a, s) < 0)) {
+				goto err;
+			} else if (UNLIKELY(_sch_dict(c) < 0)) {
+				goto err;
+			}
+			break;
+		default:
+			break;
+		}
+	}
+	return 0;
+
+err:
+	arr->release(arr);
+	if (sch->release != NULL) {
+		sch->release(sch);
+	}
+	return -1;
+}
+
+/* arrow.c ends here */
@@ -102,6 +102,41 @@ _dcmp(cots_tag_t *restrict tgt, size_t nm, const uint8_t *restrict c, size_t z)
 	return ci;
 }
 
+static size_t
+_dcmp_from(cots_tag_t *restrict tgt, size_t nm, const uint8_t *restrict c,
+	   const uint8_t *restrict bdir, size_t row0)
+{
+/* like _dcmp() but output tags from ROW0 onwards only,
+ * with a block directory start at the block containing ROW0 */
+	uint64_t pd[MAX_NM];
+	uint64_t sum = 0U;
+	size_t ci = 0U;
+	size_t r0 = 0U;
+
+	if (bdir != NULL && row0 >= P4DSIZE) {
+		/* entries start with the second block */
+		const uint8_t *e = bdir + (row0 / P4DSIZE - 1U) * BDIR_TAG_Z;
+		uint32_t o;
+
+		memcpy(&o, e, sizeof(o));
+		memcpy(&sum, e + sizeof(o), sizeof(sum));
+		ci = be32toh(o);
+		sum = be64toh(sum);
+		r0 = row0 - row0 % P4DSIZE;
+	}
+	ci += pfor_dec64(pd, c + ci, nm - r0);
+
+	/* xor-sum and output as of ROW0 */
+	for (size_t i = 0U; i < row0 - r0; i++) {
+		sum ^= pd[i];
+	}
+	for (size_t i = row0 - r0; i < nm - r0; i++) {
+		sum ^= pd[i];
+		*tgt++ = sum;
+	}
+	return ci;
+}
+
 
 /* compress */
 size_t
@@ -133,4 +168,54 @@ dcmp_tag(cots_tag_t *restrict tgt, size_t nt, const uint8_t *c, size_t nz)
 	return nt;
 }
 
+size_t
+dcmp_tag_from(
+	cots_tag_t *restrict tgt, size_t nt, const uint8_t *restrict c, size_t nz,
+	const uint8_t *restrict bdir, size_t row0)
+{
+	size_t ci = 0U;
+	size_t i = 0U;
+	(void)nz;
+
+	/* skip chunks before ROW0 */
+	for (; i + MAX_NM <= row0; i += MAX_NM) {
+		ci += pfor_skip(c + ci, MAX_NM);
+	}
+	for (; i < nt; i += MAX_NM) {
+		const size_t mt = MAX_NM < nt - i ? MAX_NM : nt - i;
+		const size_t r = row0 > i ? row0 - i : 0U;
+
+		/* directories cover single-chunk columns only */
+		ci += _dcmp_from(
+			tgt, mt, c + ci, nt <= MAX_NM ? bdir : NULL, r);
+		tgt += mt - r;
+	}
+	return nt - row0;
+}
+
+/* block directory */
+size_t
+bdir_tag(uint8_t *restrict tgt,
+	 const cots_tag_t *restrict m, size_t nm, const uint8_t *restrict c)
+{
+	size_t o = 0U;
+	size_t z = 0U;
+
+	if (UNLIKELY(nm > MAX_NM)) {
+		/* only single chunks are covered */
+		return 0U;
+	}
+	for (size_t i = P4DSIZE; i < nm; i += P4DSIZE, z += BDIR_TAG_Z) {
+		uint32_t bo;
+		uint64_t bs;
+
+		o += pfor_skip(c + o, P4DSIZE);
+		bo = htobe32(o);
+		bs = htobe64(m[i - 1U]);
+		memcpy(tgt + z, &bo, sizeof(bo));
+		memcpy(tgt + z + sizeof(bo), &bs, sizeof(bs));
+	}
+	return z;
+}
+
 /* comp-ob.c ends here */
@@ -52,4 +52,25 @@ comp_tag(uint8_t *restrict tgt, const cots_tag_t *restrict m, size_t nm);
 extern size_t
 dcmp_tag(cots_tag_t *restrict, size_t nt, const uint8_t *restrict c, size_t nz);
 
+/**
+ * Like dcmp_tag() but output only codes from row ROW0 onwards.
+ * With the column's block directory BDIR decoding starts at the block
+ * containing ROW0, BDIR can be NULL.  Return number of codes. */
+extern size_t
+dcmp_tag_from(
+	cots_tag_t *restrict, size_t nt, const uint8_t *restrict c, size_t nz,
+	const uint8_t *restrict bdir, size_t row0);
+
+/* block directory */
+/* size of an entry, block offset and the preceding code */
+#define BDIR_TAG_Z	(sizeof(uint32_t) + sizeof(uint64_t))
+
+/**
+ * Write block directory of NM metric codes M, compressed in C, to TGT.
+ * There's one entry per block but the first.
+ * Return the number of bytes. */
+extern size_t
+bdir_tag(uint8_t *restrict tgt,
+	 const cots_tag_t *restrict m, size_t nm, const uint8_t *restrict c);
+
 #endif	/* INCLUDED_comp_ob_h_ */
@@ -117,6 +117,47 @@ _dcmp(uint32_t *restrict tgt, size_t np, const uint8_t *restrict c, size_t z)
 	return ci;
 }
 
+static size_t
+_dcmp_from(uint32_t *restrict tgt, size_t np, const uint8_t *restrict c,
+	   const uint8_t *restrict bdir, size_t row0)
+{
+/* like _dcmp() but output values from ROW0 onwards only,
+ * with a block directory start at the block containing ROW0 */
+	uint16_t nibl[2U * MAX_NP];
+	uint32_t o[2U] = {0U};
+	uint32_t sum = 0U;
+	size_t r0 = 0U;
+
+	if (bdir != NULL && row0 >= P4DSIZE) {
+		/* entries start with the second block */
+		const uint8_t *e = bdir + (row0 / P4DSIZE - 1U) * BDIR_PX_Z;
+
+		memcpy(o, e, sizeof(o));
+		memcpy(&sum, e + sizeof(o), sizeof(sum));
+		for (size_t k = 0U; k < 2U; k++) {
+			o[k] = be32toh(o[k]);
+		}
+		sum = be32toh(sum);
+		r0 = row0 - row0 % P4DSIZE;
+	}
+	for (size_t k = 0U, ci = 0U; k < 2U; k++) {
+		/* without directory the streams are back to back */
+		ci = o[k] ?: ci;
+		ci += pfor_dec16(nibl + k * MAX_NP, c + ci, np - r0);
+		o[k] = ci;
+	}
+
+	/* reassemble words, xor-sum them and output as of ROW0 */
+	for (size_t i = 0U; i < np - r0; i++) {
+		sum ^= (uint32_t)nibl[i + 0U * MAX_NP];
+		sum ^= (uint32_t)nibl[i + 1U * MAX_NP] << 16U;
+		if (i >= row0 - r0) {
+			*tgt++ = sum;
+		}
+	}
+	return o[1U];
+}
+
 
 /* compress */
 size_t
@@ -148,4 +189,63 @@ dcmp_px(uint32_t *restrict tgt, size_t nt, const uint8_t *restrict c, size_t nz)
 	return nt;
 }
 
+size_t
+dcmp_px_from(
+	uint32_t *restrict tgt, size_t nt, const uint8_t *restrict c, size_t nz,
+	const uint8_t *restrict bdir, size_t row0)
+{
+	size_t ci = 0U;
+	size_t i = 0U;
+	(void)nz;
+
+	/* skip chunks before ROW0, stream by stream */
+	for (; i + MAX_NP <= row0; i += MAX_NP) {
+		for (size_t k = 0U; k < 2U; k++) {
+			ci += pfor_skip(c + ci, MAX_NP);
+		}
+	}
+	for (; i < nt; i += MAX_NP) {
+		const size_t mt = MAX_NP < nt - i ? MAX_NP : nt - i;
+		const size_t r = row0 > i ? row0 - i : 0U;
+
+		/* directories cover single-chunk columns only */
+		ci += _dcmp_from(
+			tgt, mt, c + ci, nt <= MAX_NP ? bdir : NULL, r);
+		tgt += mt - r;
+	}
+	return nt - row0;
+}
+
+/* block directory */
+size_t
+bdir_px(uint8_t *restrict tgt,
+	const uint32_t *restrict px, size_t np, const uint8_t *restrict c)
+{
+	size_t o[2U];
+	size_t z = 0U;
+
+	if (UNLIKELY(np > MAX_NP)) {
+		/* only single chunks are covered */
+		return 0U;
+	}
+	/* streams are back to back */
+	o[0U] = 0U;
+	for (size_t k = 1U; k < 2U; k++) {
+		o[k] = o[k - 1U] + pfor_skip(c + o[k - 1U], np);
+	}
+	for (size_t i = P4DSIZE; i < np; i += P4DSIZE, z += BDIR_PX_Z) {
+		uint32_t bo[2U];
+		uint32_t bs;
+
+		for (size_t k = 0U; k < 2U; k++) {
+			o[k] += pfor_skip(c + o[k], P4DSIZE);
+			bo[k] = htobe32(o[k]);
+		}
+		bs = htobe32(px[i - 1U]);
+		memcpy(tgt + z, bo, sizeof(bo));
+		memcpy(tgt + z + sizeof(bo), &bs, sizeof(bs));
+	}
+	return z;
+}
+
 /* comp-px.c ends here */
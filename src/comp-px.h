@@ -52,4 +52,25 @@ comp_px(uint8_t *restrict tgt, const uint32_t *restrict px, size_t np);
 extern size_t
 dcmp_px(uint32_t *restrict t, size_t nt, const uint8_t *restrict c, size_t nz);
 
+/**
+ * Like dcmp_px() but output only values from row ROW0 onwards.
+ * With the column's block directory BDIR decoding starts at the block
+ * containing ROW0, BDIR can be NULL.  Return number of values. */
+extern size_t
+dcmp_px_from(
+	uint32_t *restrict t, size_t nt, const uint8_t *restrict c, size_t nz,
+	const uint8_t *restrict bdir, size_t row0);
+
+/* block directory */
+/* size of an entry, offsets into all 2 streams and the preceding value */
+#define BDIR_PX_Z	(2U * sizeof(uint32_t) + sizeof(uint32_t))
+
+/**
+ * Write block directory of NP price values in PX, compressed in C, to TGT.
+ * There's one entry per block but the first.
+ * Return the number of bytes. */
+extern size_t
+bdir_px(uint8_t *restrict tgt,
+	const uint32_t *restrict px, size_t np, const uint8_t *restrict c);
+
 #endif	/* INCLUDED_comp_px_h_ */
@@ -52,4 +52,25 @@ comp_qx(uint8_t *restrict tgt, const uint64_t *restrict qx, size_t np);
 extern size_t
 dcmp_qx(uint64_t *restrict t, size_t nt, const uint8_t *restrict c, size_t nz);
 
+/**
+ * Like dcmp_qx() but output only values from row ROW0 onwards.
+ * With the column's block directory BDIR decoding starts at the block
+ * containing ROW0, BDIR can be NULL.  Return number of values. */
+extern size_t
+dcmp_qx_from(
+	uint64_t *restrict t, size_t nt, const uint8_t *restrict c, size_t nz,
+	const uint8_t *restrict bdir, size_t row0);
+
+/* block directory */
+/* size of an entry, offsets into all 4 streams and the preceding value */
+#define BDIR_QX_Z	(4U * sizeof(uint32_t) + sizeof(uint64_t))
+
+/**
+ * Write block directory of NP quantity values in QX, compressed in C, to TGT.
+ * There's one entry per block but the first.
+ * Return the number of bytes. */
+extern size_t
+bdir_qx(uint8_t *restrict tgt,
+	const uint64_t *restrict qx, size_t np, const uint8_t *restrict c);
+
 #endif	/* INCLUDED_comp_qx_h_ */
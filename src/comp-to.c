@@ -157,6 +157,51 @@ _dcmp(cots_to_t *restrict tgt, size_t nt, const uint8_t *restrict c, size_t z)
 	return ci;
 }
 
+static size_t
+_dcmp_from(cots_to_t *restrict tgt, size_t nt, const uint8_t *restrict c,
+	   const uint8_t *restrict bdir, size_t row0)
+{
+/* like _dcmp() but output offsets from ROW0 onwards only,
+ * with a block directory start at the block containing ROW0 */
+	cots_to_t td[MAX_NT];
+	cots_to_t avg;
+	cots_to_t sum = 0U;
+	unsigned int dsh;
+	size_t ci = sizeof(uint64_t);
+	size_t r0 = 0U;
+
+	/* snarf average+delta value */
+	with (uint64_t ad) {
+		memcpy(&ad, c, sizeof(ad));
+		ad = be64toh(ad);
+		avg = ad >> 1U;
+		dsh = ad & 0b1U;
+	}
+	if (bdir != NULL && row0 >= P4DSIZE) {
+		/* entries start with the second block */
+		const uint8_t *e = bdir + (row0 / P4DSIZE - 1U) * BDIR_TO_Z;
+		uint32_t o;
+
+		memcpy(&o, e, sizeof(o));
+		memcpy(&sum, e + sizeof(o), sizeof(sum));
+		ci = be32toh(o);
+		sum = be64toh(sum);
+		r0 = row0 - row0 % P4DSIZE;
+	}
+	ci += pfor_dec64(td, c + ci, nt - r0);
+
+	/* add average, then cumsum and output as of ROW0 */
+	adavgt(td, nt - r0, avg, dsh);
+	for (size_t i = 0U; i < row0 - r0; i++) {
+		sum += td[i];
+	}
+	for (size_t i = row0 - r0; i < nt - r0; i++) {
+		sum += td[i];
+		*tgt++ = sum;
+	}
+	return ci;
+}
+
 
 /* compress */
 size_t
@@ -188,4 +233,55 @@ dcmp_to(cots_to_t *restrict tgt, size_t nt, const uint8_t *c, size_t nz)
 	return nt;
 }
 
+size_t
+dcmp_to_from(
+	cots_to_t *restrict tgt, size_t nt, const uint8_t *restrict c, size_t nz,
+	const uint8_t *restrict bdir, size_t row0)
+{
+	size_t ci = 0U;
+	size_t i = 0U;
+	(void)nz;
+
+	/* chunks before ROW0 come with their own header, skip them */
+	for (; i + MAX_NT <= row0; i += MAX_NT) {
+		ci += sizeof(uint64_t);
+		ci += pfor_skip(c + ci, MAX_NT);
+	}
+	for (; i < nt; i += MAX_NT) {
+		const size_t mt = MAX_NT < nt - i ? MAX_NT : nt - i;
+		const size_t r = row0 > i ? row0 - i : 0U;
+
+		/* directories cover single-chunk columns only */
+		ci += _dcmp_from(
+			tgt, mt, c + ci, nt <= MAX_NT ? bdir : NULL, r);
+		tgt += mt - r;
+	}
+	return nt - row0;
+}
+
+/* block directory */
+size_t
+bdir_to(uint8_t *restrict tgt,
+	const cots_to_t *restrict to, size_t nt, const uint8_t *restrict c)
+{
+	size_t o = sizeof(uint64_t);
+	size_t z = 0U;
+
+	if (UNLIKELY(nt > MAX_NT)) {
+		/* only single chunks are covered */
+		return 0U;
+	}
+	for (size_t i = P4DSIZE; i < nt; i += P4DSIZE, z += BDIR_TO_Z) {
+		uint32_t bo;
+		uint64_t bs;
+
+		o += pfor_skip(c + o, P4DSIZE);
+		bo = htobe32(o);
+		bs = htobe64(to[i - 1U]);
+		memcpy(tgt + z, &bo, sizeof(bo));
+		memcpy(tgt + z + sizeof(bo), &bs, sizeof(bs));
+	}
+	return z;
+}
+
 /* comp-to.c ends here */
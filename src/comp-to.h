@@ -53,4 +53,25 @@ comp_to(uint8_t *restrict tgt, const cots_to_t *restrict to, size_t nt);
 extern size_t
 dcmp_to(cots_to_t *restrict t, size_t nt, const uint8_t *restrict c, size_t nz);
 
+/**
+ * Like dcmp_to() but output only offsets from row ROW0 onwards.
+ * With the column's block directory BDIR decoding starts at the block
+ * containing ROW0, BDIR can be NULL.  Return number of offsets. */
+extern size_t
+dcmp_to_from(
+	cots_to_t *restrict t, size_t nt, const uint8_t *restrict c, size_t nz,
+	const uint8_t *restrict bdir, size_t row0);
+
+/* block directory */
+/* size of an entry, block offset and the value preceding the block */
+#define BDIR_TO_Z	(sizeof(uint32_t) + sizeof(uint64_t))
+
+/**
+ * Write block directory of NT time offsets TO, compressed in C, to TGT.
+ * There's one entry per block but the first.
+ * Return the number of bytes. */
+extern size_t
+bdir_to(uint8_t *restrict tgt,
+	const cots_to_t *restrict to, size_t nt, const uint8_t *restrict c);
+
 #endif	/* INCLUDED_comp_to_h_ */
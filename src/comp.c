@@ -47,20 +47,87 @@
 #include "comp-px.h"
 #include "comp-qx.h"
 #include "comp-ob.h"
+#include "pfor.h"
 #include "nifty.h"
 
 #define ALGN16(x)	(void*)((uintptr_t)((x) + 0xfU) & ~0xfULL)
 
+/* codecs compress at most this many values in one go,
+ * block directories are confined to that */
+#define MAX_BDIR	(8192U)
+
+
+static size_t
+_bdir_z(char lo)
+{
+/* size of block directory entries for columns of type LO */
+	switch (lo) {
+	case COTS_LO_PRC:
+	case COTS_LO_FLT:
+		return BDIR_PX_Z;
+	case COTS_LO_CNT:
+	case COTS_LO_TIM:
+		return BDIR_TO_Z;
+	case COTS_LO_SIZ:
+	case COTS_LO_STR:
+		return BDIR_TAG_Z;
+	case COTS_LO_QTY:
+	case COTS_LO_DBL:
+		return BDIR_QX_Z;
+	default:
+		break;
+	}
+	return 0U;
+}
+
+static size_t
+_bdir(uint8_t *restrict tgt, size_t ncols, size_t nrows, const char *layout,
+      const struct cots_tsoa_s *cols, const uint8_t *const *c)
+{
+/* write block directories of all columns, compressed in C, to TGT */
+	size_t z = 0U;
+
+	z += bdir_to(tgt + z, cols->toffs, nrows, c[0U]);
+	for (size_t i = 0U; i < ncols; i++) {
+		switch (layout[i]) {
+		case COTS_LO_PRC:
+		case COTS_LO_FLT:
+			z += bdir_px(tgt + z, cols->cols[i], nrows, c[i + 1U]);
+			break;
+
+		case COTS_LO_CNT:
+		case COTS_LO_TIM:
+			z += bdir_to(tgt + z, cols->cols[i], nrows, c[i + 1U]);
+			break;
+
+		case COTS_LO_SIZ:
+		case COTS_LO_STR:
+			z += bdir_tag(tgt + z, cols->cols[i], nrows, c[i + 1U]);
+			break;
+
+		case COTS_LO_QTY:
+		case COTS_LO_DBL:
+			z += bdir_qx(tgt + z, cols->cols[i], nrows, c[i + 1U]);
+			break;
+		default:
+			break;
+		}
+	}
+	return z;
+}
+
 
 size_t
 comp(uint8_t *restrict tgt, size_t ncols, size_t nrows, const char *layout,
-     const struct cots_tsoa_s *cols)
+     const struct cots_tsoa_s *cols, int bdir)
 {
+	const uint8_t *cd[ncols + 1U];
 	uint64_t tz;
 	size_t totz = 0U;
 	size_t z;
 
 	/* toffs first */
+	cd[0U] = tgt + totz + sizeof(tz);
 	z = comp_to(tgt + totz + sizeof(tz), cols->toffs, nrows);
 	/* bang type+size cell */
 	tz = (z << 8U) ^ ((uint8_t)COTS_LO_TIM);
@@ -70,6 +137,7 @@ comp(uint8_t *restrict tgt, size_t ncols, size_t nrows, const char *layout,
 
 	/* columns now */
 	for (size_t i = 0U; i < ncols; i++) {
+		cd[i + 1U] = tgt + totz + sizeof(tz);
 		switch (layout[i]) {
 		case COTS_LO_PRC:
 		case COTS_LO_FLT: {
@@ -111,6 +179,16 @@ comp(uint8_t *restrict tgt, size_t ncols, size_t nrows, const char *layout,
 		memcpy(tgt + totz, &tz, sizeof(tz));
 		totz += z + sizeof(tz);
 	}
+
+	/* block directories, if wanted and there's more than one block */
+	if (bdir && P4DSIZE < nrows && nrows <= MAX_BDIR) {
+		z = _bdir(tgt + totz + sizeof(tz), ncols, nrows, layout, cols, cd);
+		/* bang type+size cell */
+		tz = (z << 8U) ^ ((uint8_t)COMP_BDIR);
+		tz = htobe64(tz);
+		memcpy(tgt + totz, &tz, sizeof(tz));
+		totz += z + sizeof(tz);
+	}
 	return totz;
 }
 
@@ -150,6 +228,10 @@ dcmp(struct cots_tsoa_s *restrict cols,
 			return 0U;
 		} else if (UNLIKELY(si + (z = tz >> 8U) > ssz)) {
 			return 0U;
+		} else if (cols->cols[i] == NULL) {
+			/* column's not wanted, skip it */
+			si += z;
+			continue;
 		}
 
 		switch (layout[i]) {
@@ -196,4 +278,109 @@ dcmp(struct cots_tsoa_s *restrict cols,
 	return nrows;
 }
 
+size_t
+dcmp_from(struct cots_tsoa_s *restrict cols,
+	  size_t ncols, size_t nrows,
+	  const char *layout, const uint8_t *restrict src, size_t ssz,
+	  size_t row0)
+{
+	/* column cells, the time column's being the first */
+	size_t co[ncols + 1U];
+	size_t cz[ncols + 1U];
+	const uint8_t *bd = NULL;
+	uint64_t tz;
+	size_t si = 0U;
+	size_t nt;
+
+	if (UNLIKELY(row0 >= nrows)) {
+		return 0U;
+	}
+	for (size_t i = 0U; i <= ncols; i++) {
+		const char lo = i ? layout[i - 1U] : COTS_LO_TIM;
+
+		if (UNLIKELY(si + sizeof(tz) > ssz)) {
+			return 0U;
+		}
+		memcpy(&tz, src + si, sizeof(tz));
+		si += sizeof(tz);
+		tz = be64toh(tz);
+		/* check type and size */
+		if (UNLIKELY((char)(tz & 0xffU) != lo)) {
+			return 0U;
+		} else if (UNLIKELY(si + (cz[i] = tz >> 8U) > ssz)) {
+			return 0U;
+		}
+		co[i] = si;
+		si += cz[i];
+	}
+
+	/* block directories follow, for pages with more than one block
+	 * written by versions that know about them */
+	if (si + sizeof(tz) <= ssz) {
+		size_t bz = _bdir_z(COTS_LO_TIM);
+
+		for (size_t i = 0U; i < ncols; i++) {
+			bz += _bdir_z(layout[i]);
+		}
+		bz *= (nrows - 1U) / P4DSIZE;
+
+		memcpy(&tz, src + si, sizeof(tz));
+		si += sizeof(tz);
+		tz = be64toh(tz);
+		if ((char)(tz & 0xffU) == COMP_BDIR &&
+		    (tz >> 8U) == bz && si + bz <= ssz) {
+			bd = src + si;
+		}
+	}
+
+	/* times first */
+	nt = dcmp_to_from(cols->toffs, nrows, src + co[0U], cz[0U], bd, row0);
+	if (UNLIKELY(nt != nrows - row0)) {
+		return 0U;
+	}
+	bd = bd ? bd + _bdir_z(COTS_LO_TIM) * ((nrows - 1U) / P4DSIZE) : NULL;
+
+	/* columns now */
+	for (size_t i = 0U; i < ncols; i++) {
+		const uint8_t *c = src + co[i + 1U];
+		const size_t z = cz[i + 1U];
+		const uint8_t *cbd = bd;
+
+		bd = bd ? bd + _bdir_z(layout[i]) * ((nrows - 1U) / P4DSIZE) : NULL;
+		if (cols->cols[i] == NULL) {
+			/* column's not wanted, skip it */
+			continue;
+		}
+
+		switch (layout[i]) {
+		case COTS_LO_PRC:
+		case COTS_LO_FLT:
+			nt = dcmp_px_from(cols->cols[i], nrows, c, z, cbd, row0);
+			break;
+
+		case COTS_LO_CNT:
+		case COTS_LO_TIM:
+			nt = dcmp_to_from(cols->cols[i], nrows, c, z, cbd, row0);
+			break;
+
+		case COTS_LO_SIZ:
+		case COTS_LO_STR:
+			nt = dcmp_tag_from(cols->cols[i], nrows, c, z, cbd, row0);
+			break;
+
+		case COTS_LO_QTY:
+		case COTS_LO_DBL:
+			nt = dcmp_qx_from(cols->cols[i], nrows, c, z, cbd, row0);
+			break;
+		default:
+			break;
+		}
+		/* check if all columns have the same number o ticks */
+		if (UNLIKELY(nt != nrows - row0)) {
+			return 0U;
+		}
+	}
+	return nrows - row0;
+}
+
 /* comp.c ends here */
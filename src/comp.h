@@ -39,14 +39,32 @@
 #include <stdlib.h>
 #include "cotse.h"
 
+/* cell type of block directories, behind the columns */
+#define COMP_BDIR	'#'
+/* decoders may write up to this many values past the end of a column */
+#define DCMP_SPILL	(64U)
 
+/**
+ * Compress NROWS rows of COLS into TGT, append block directories
+ * if BDIR is non-0.  Return the number of octets written. */
 extern size_t
 comp(uint8_t *restrict tgt, size_t ncols, size_t nrows, const char *layout,
-     const struct cots_tsoa_s *cols);
+     const struct cots_tsoa_s *cols, int bdir);
 
 extern size_t
 dcmp(struct cots_tsoa_s *restrict cols,
      size_t ncols, size_t nrows,
      const char *layout, const uint8_t *restrict src, size_t ssz);
 
+/**
+ * Like dcmp() but output only rows from ROW0 onwards.
+ * Pages with block directories are decoded from the block containing
+ * ROW0, others are decoded from the start.
+ * Return the number of rows output. */
+extern size_t
+dcmp_from(struct cots_tsoa_s *restrict cols,
+	  size_t ncols, size_t nrows,
+	  const char *layout, const uint8_t *restrict src, size_t ssz,
+	  size_t row0);
+
 #endif	/* INCLUDED_comp_h_ */
@@ -50,11 +50,15 @@
 #include <errno.h>
 #include <math.h>
 #include <assert.h>
+#include <time.h>
+#include <pthread.h>
 #include "cotse.h"
 #include "index.h"
 #include "wal.h"
 #include "comp.h"
 #include "intern.h"
+#include "pcache.h"
+#include "uring.h"
 #include "boobs.h"
 #include "nifty.h"
 
@@ -71,6 +75,12 @@
 #define ALGN4(x)	((uintptr_t)((x) + 0x3U) & ~0x3ULL)
 #define ALGN2(x)	((uintptr_t)((x) + 0x1U) & ~0x1ULL)
 
+/* size of the read window */
+#define RMAPZ		(64ULL << 20U)
+/* size of direct read windows and their alignment */
+#define DWINZ		(4ULL << 20U)
+#define DALGN		(4096U)
+
 /* file header, mmapped for convenience */
 struct fhdr_s {
 	/* should be "cots" */
@@ -80,7 +90,8 @@ struct fhdr_s {
 	/* COTS_ENDIAN written in native endian */
 	uint16_t endian;
 	/* tba
-	 * - lowest 4bits of flags is the log2 of the block size minus 9 */
+	 * - lowest 4bits of flags is the log2 of the block size minus 9
+	 * - bit 4 is set if pages carry block directories */
 	uint64_t flags;
 	/* offset to meta */
 	uint64_t moff;
@@ -89,6 +100,11 @@ struct fhdr_s {
 	/* layout, \nul term'd */
 	uint8_t layout[];
 };
+/* header flag, pages are written with block directories */
+#define FHDR_BDIR	(1ULL << 4U)
+/* header flag, set while a page is being flushed asynchronously
+ * and the writer's WAL has moved on to the next page already */
+#define FHDR_INFL	(1ULL << 63U)
 
 struct blob_s {
 	size_t z;
@@ -111,6 +127,149 @@ struct pagf_s {
 	unsigned int bits;
 };
 
+/* read windows, mapping of a file at offset O */
+struct rwin_s {
+	const uint8_t *p;
+	off_t o;
+	size_t z;
+	/* for direct reads, the aligned buffer P reads into,
+	 * its size and the descriptor to read from */
+	uint8_t *dbuf;
+	size_t dbz;
+	int dfd;
+};
+
+/* prefetched pages */
+struct pfsl_s {
+	/* page offset and offset of the next page */
+	off_t o;
+	off_t no;
+	ssize_t nt;
+	struct cots_tsoa_s *t;
+};
+
+/* read-ahead state, shared with the worker thread */
+struct pf_s {
+	pthread_t th;
+	pthread_mutex_t mtx;
+	pthread_cond_t cnd;
+	/* worker's own read window */
+	struct rwin_s rw;
+	/* offset of the next page to decode and end of pages */
+	off_t o;
+	off_t eo;
+	/* bumped on repositioning, so stale pages can be told apart */
+	size_t gen;
+	int quit;
+	/* ring of decoded pages, occupied are [head, tail) */
+	size_t head;
+	size_t tail;
+	size_t nsl;
+	struct pfsl_s sl[];
+};
+
+/* statistics, the octet counts go after the public part */
+struct st_s {
+	struct cots_stats_s pub;
+	uint64_t z[];
+};
+
+/* durability policy */
+struct dur_s {
+	unsigned int how;
+	/* sync the WAL every N ticks or USEC microseconds */
+	size_t n;
+	uint64_t usec;
+	/* ticks since and time of the last WAL sync */
+	size_t nt;
+	uint64_t last;
+};
+
+/* asynchronous flushing, shared with the compaction worker */
+struct cw_s {
+	pthread_t th;
+	pthread_mutex_t mtx;
+	pthread_cond_t cnd;
+	/* the worker's copy of a full WAL, and its columnar twin */
+	struct cots_wal_s *w;
+	struct cots_wal_s *m;
+	/* whether W is yet to be flushed, and the first error */
+	int busy;
+	int rc;
+	int quit;
+	/* ticks in W not accounted for in the statistics yet */
+	size_t nt;
+};
+
+/* parallel scans */
+struct scan_s {
+	struct _ss_s *_s;
+	cots_scan_f cb;
+	void *clo;
+	/* next page to hand out */
+	size_t next;
+	/* ticks delivered so far */
+	size_t nt;
+	int stop;
+	int err;
+};
+
+/* OHLCV bars, NB ticks so far, bars start at BT */
+struct bar_s {
+	cots_to_t bt;
+	size_t nb;
+	int haspx;
+	cots_px_t o, h, l, c;
+	cots_qx_t v;
+};
+
+/* resampling state */
+struct rsmp_s {
+	cots_to_t ival;
+	cots_to_t from;
+	cots_to_t till;
+	/* price and quantity fields, -1 if there is none */
+	ssize_t pi;
+	ssize_t qi;
+	/* current page, its tick count and the next tick to look at */
+	struct cots_tsoa_s *pg;
+	size_t n;
+	size_t i;
+	int eof;
+	/* bar under construction */
+	struct bar_s b;
+};
+
+/* rollups, pre-aggregated bars in a companion series */
+struct rlp_s {
+	cots_to_t ival;
+	cots_ts_t ts;
+	/* where the companion lives in a frozen file, relative to the series */
+	struct orng_s r;
+	/* bar under construction, written out once the interval is over */
+	struct bar_s b;
+};
+
+/* rows of rollup series */
+struct rlpt_s {
+	struct cots_tick_s proto;
+	cots_px_t o, h, l, c;
+	cots_qx_t v;
+};
+
+/* page directory entries */
+struct pgde_s {
+	/* time offset of the first tick on the page */
+	cots_to_t from;
+	/* page offsets within the file */
+	off_t beg;
+	off_t end;
+	/* number of ticks on the page */
+	size_t nt;
+	/* whether there's a zone map for the page */
+	unsigned int zoned;
+};
+
 struct _ss_s {
 	struct cots_ss_s public;
 
@@ -130,21 +289,65 @@ struct _ss_s {
 	/* currently attached file and its opening flags */
 	int fd;
 	int fl;
+	/* file identity, for the page cache */
+	dev_t dev;
+	ino_t ino;
 	/* current offset for next blob */
 	off_t fo;
+	/* whether to write block directories */
+	int bdir;
+	/* offset of the series within the file, for embedded series */
+	off_t bo;
 	/* current offset for reading */
 	off_t ro;
 	/* offset in ticks within the page */
 	size_t rt;
+	/* read window over the backing file */
+	struct rwin_s rw;
+	/* descriptor for direct reads of pages, or -1 */
+	int dfd;
+	/* read-ahead, if any */
+	struct pf_s *pf;
+	/* asynchronous page reads, if any */
+	struct ur_s *ur;
+	/* asynchronous flushing, if any */
+	struct cw_s *cw;
+	/* durability policy */
+	struct dur_s dur;
+	/* followed writer's WAL, mapped read-only, if following */
+	int flw;
+	const struct cots_wal_s *fwal;
+	/* range of the current range read, if any */
+	struct trng_s rng;
 
 	/* index, if any, this will be recursive */
 	cots_idx_t idx;
+	/* page directory, built from the index upon first seek */
+	struct pgde_s *pgd;
+	size_t npgd;
+	size_t zpgd;
+	/* zone maps alongside, laid out as in the index */
+	uint8_t *zon;
+	/* resampling, if any */
+	struct rsmp_s *rs;
+	/* rollups, if any, and the number of WAL ticks they've seen */
+	struct rlp_s *rlp;
+	size_t nrlp;
+	size_t rlpt;
+	/* page last decoded for as-of lookups, its offset and tick count */
+	struct cots_tsoa_s *apg;
+	off_t apo;
+	size_t apn;
 
 	/* obarray */
 	cots_ob_t ob;
+
+	/* statistics, if any */
+	struct st_s *st;
 };
 
 static const char nul_layout[] = "";
+static const char rlp_layout[] = "ppppq";
 
 
 static size_t
@@ -304,6 +507,164 @@ _layo_impr(struct cots_tsoa_s *tgt, void *mem,
 	return 0;
 }
 
+/* zone maps */
+static size_t
+_zone_n(const char *flds, size_t nflds)
+{
+/* number of zone-mapped fields in FLDS */
+	size_t n = 0U;
+
+	for (size_t i = 0U; i < nflds; i++) {
+		n += !!cots_zone_lo(flds[i]);
+	}
+	return n;
+}
+
+static size_t
+_zone_z(const char *flds, size_t nflds)
+{
+/* size of one page's zone map, min/max pairs of all zone-mapped fields */
+	size_t z = 0U;
+
+	for (size_t i = 0U; i < nflds; i++) {
+		z += 2U * _layo_wid(cots_zone_lo(flds[i]));
+	}
+	return z;
+}
+
+static size_t
+_zone_off(const char *flds, size_t fld)
+{
+/* offset of field FLD's min/max pair within a zone map */
+	return _zone_z(flds, fld);
+}
+
+static void
+_zone_row(uint8_t *restrict tgt, const struct cots_tsoa_s *src,
+	  const char *flds, size_t nflds, size_t nt)
+{
+/* compute min/max of the zone-mapped columns of SRC, NaNs only make it
+ * if the column is all NaNs */
+#define ZONE(T)								\
+	with (const T *v = src->cols[i]) {				\
+		T lo = v[0U], hi = v[0U];				\
+									\
+		for (size_t j = 1U; j < nt; j++) {			\
+			lo = v[j] < lo || lo != lo ? v[j] : lo;		\
+			hi = v[j] > hi || hi != hi ? v[j] : hi;		\
+		}							\
+		memcpy(tgt, &lo, sizeof(lo));				\
+		memcpy(tgt + sizeof(lo), &hi, sizeof(hi));		\
+		tgt += 2U * sizeof(lo);					\
+	}
+
+	for (size_t i = 0U; i < nflds; i++) {
+		switch (flds[i]) {
+		case COTS_LO_PRC:
+			ZONE(cots_px_t);
+			break;
+		case COTS_LO_QTY:
+			ZONE(cots_qx_t);
+			break;
+		case COTS_LO_FLT:
+			ZONE(float);
+			break;
+		case COTS_LO_DBL:
+			ZONE(double);
+			break;
+		case COTS_LO_STR:
+			ZONE(cots_tag_t);
+			break;
+		default:
+			break;
+		}
+	}
+#undef ZONE
+	return;
+}
+
+static int
+_zone_sat(char lo, const void *min, const void *max,
+	  const struct cots_pred_s *p)
+{
+/* could a value within [MIN, MAX] of type LO satisfy predicate P? */
+#define SAT(T)								\
+	with (T l, h, v) {						\
+		memcpy(&l, min, sizeof(l));				\
+		memcpy(&h, max, sizeof(h));				\
+		memcpy(&v, &p->val, sizeof(v));				\
+		switch (p->op) {					\
+		case COTS_OP_LT:					\
+			return l < v;					\
+		case COTS_OP_LE:					\
+			return l <= v;					\
+		case COTS_OP_GT:					\
+			return h > v;					\
+		case COTS_OP_GE:					\
+			return h >= v;					\
+		case COTS_OP_EQ:					\
+			return l <= v && v <= h;			\
+		default:						\
+			break;						\
+		}							\
+	}
+
+	switch (lo) {
+	case COTS_LO_PRC:
+		SAT(cots_px_t);
+		break;
+	case COTS_LO_QTY:
+		SAT(cots_qx_t);
+		break;
+	case COTS_LO_FLT:
+		SAT(float);
+		break;
+	case COTS_LO_DBL:
+		SAT(double);
+		break;
+	case COTS_LO_STR:
+		SAT(cots_tag_t);
+		break;
+	default:
+		break;
+	}
+#undef SAT
+	/* don't know */
+	return 1;
+}
+
+static inline void
+_bar_new(struct bar_s *b, cots_to_t bt)
+{
+	b->bt = bt;
+	b->nb = 0U;
+	b->haspx = 0;
+	b->o = b->h = b->l = b->c = COTS_PX_MISS.d32;
+	b->v = 0.dd;
+	return;
+}
+
+static inline void
+_bar_add(struct bar_s *b, const cots_px_t *px, const cots_qx_t *qx, size_t i)
+{
+/* fold the I-th tick of PX and QX (either of which may be NULL) into B */
+	if (px != NULL && memcmp(px + i, &COTS_PX_MISS, sizeof(*px))) {
+		const cots_px_t p = px[i];
+
+		if (!b->haspx) {
+			b->o = b->h = b->l = p;
+			b->haspx = 1;
+		}
+		b->h = p > b->h ? p : b->h;
+		b->l = p < b->l ? p : b->l;
+		b->c = p;
+	}
+	/* volume is the sum of quantities or the number of ticks */
+	b->v += qx != NULL ? qx[i] : 1.dd;
+	b->nb++;
+	return;
+}
+
 
 /* _ss_s and cots_ts_t fiddlers */
 static inline void
@@ -365,6 +726,10 @@ _bang_tick(
 
 		/* get current field's width and alignment */
 		a += wid, wid = _layo_wid(flds[i]), a = _layo_algn(a, wid);
+		if (c == NULL) {
+			/* not projected */
+			continue;
+		}
 		for (size_t j = ot; j < nrows; j++) {
 			memcpy(c + j * wid, rows + j * zrow + a, wid);
 		}
@@ -372,29 +737,152 @@ _bang_tick(
 	return 0;
 }
 
+static void
+_row_tick(uint8_t *restrict row, const struct cots_tsoa_s *cols, size_t j,
+	  const char *flds, size_t nflds)
+{
+/* the inverse of _bang_tick() for the single tick J in COLS */
+	memcpy(row, cols->toffs + j, sizeof(*cols->toffs));
+	for (size_t i = 0U, a = _layo_zrow(flds, i), wid = 0U; i < nflds; i++) {
+		const uint8_t *c = cols->cols[i];
+
+		/* get current field's width and alignment */
+		a += wid, wid = _layo_wid(flds[i]), a = _layo_algn(a, wid);
+		memcpy(row + a, c + j * wid, wid);
+	}
+	return;
+}
+
+static size_t
+_wal_cols(struct cots_tsoa_s *restrict cols, struct _ss_s *_s)
+{
+/* imprint the column-oriented WAL on COLS after columnifying any rows
+ * that haven't been, return the number of rows */
+	const size_t blkz = _s->public.blockz;
+	const size_t nflds = _s->public.nfields;
+	const char *layo = _s->public.layout;
+	const size_t nr = _wal_rowi(_s->mwal);
+	const size_t nt = _wal_rowi(_s->wal);
+
+	_layo_impr(cols, _s->mwal->data, layo, nflds, blkz);
+	if (nt > nr) {
+		/* columnify again */
+		_bang_tick(cols, _s->wal->data, nt, layo, nflds, nr);
+		_wal_rset(_s->mwal, nt);
+	}
+	return nt;
+}
+
+static void
+_rev_tsoa(struct cots_tsoa_s *restrict tgt, size_t n,
+	  const char *flds, size_t nflds)
+{
+/* reverse the order of the first N ticks in TGT */
+	for (size_t j = 0U, k = n; j + 1U < k; j++, k--) {
+		const cots_to_t t = tgt->toffs[j];
+
+		tgt->toffs[j] = tgt->toffs[k - 1U];
+		tgt->toffs[k - 1U] = t;
+	}
+	for (size_t i = 0U; i < nflds; i++) {
+		const size_t wid = _layo_wid(flds[i]);
+		uint8_t *c = tgt->cols[i];
+
+		if (c == NULL) {
+			/* not projected */
+			continue;
+		}
+		for (size_t j = 0U, k = n; j + 1U < k; j++, k--) {
+			uint8_t tmp[sizeof(uint64_t)];
+
+			memcpy(tmp, c + j * wid, wid);
+			memcpy(c + j * wid, c + (k - 1U) * wid, wid);
+			memcpy(c + (k - 1U) * wid, tmp, wid);
+		}
+	}
+	return;
+}
+
+static uint64_t
+_now_ns(void)
+{
+	struct timespec tsp;
+
+	clock_gettime(CLOCK_MONOTONIC, &tsp);
+	return tsp.tv_sec * 1000000000ULL + tsp.tv_nsec;
+}
+
+static struct st_s*
+_make_st(size_t nflds)
+{
+/* statistics for NFLDS fields and the time column */
+	struct st_s *st;
+
+	st = calloc(1U, sizeof(*st) + 2U * (nflds + 1U) * sizeof(*st->z));
+	if (UNLIKELY(st == NULL)) {
+		return NULL;
+	}
+	st->pub.ncols = nflds + 1U;
+	st->pub.rawz = st->z;
+	st->pub.compz = st->z + nflds + 1U;
+	return st;
+}
+
+static void
+_st_hist(struct cots_hist_s *h, uint64_t ns)
+{
+/* account for an event that took NS nanoseconds,
+ * bucket I holds durations in [2^I, 2^(I+1)) */
+	size_t i = ns ? 63U - __builtin_clzll(ns) : 0U;
+
+	i = i < COTS_HISTZ ? i : COTS_HISTZ - 1U;
+	__atomic_fetch_add(&h->n, 1U, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&h->sum, ns, __ATOMIC_RELAXED);
+	__atomic_fetch_add(h->h + i, 1U, __ATOMIC_RELAXED);
+	return;
+}
+
+static void
+_st_page(struct st_s *st, const struct blob_s b,
+	 const char *flds, size_t nflds, size_t nrows)
+{
+/* account for page B holding NROWS ticks,
+ * the page's cells come in column order, time first */
+	uint64_t *rawz = st->z;
+	uint64_t *compz = st->z + nflds + 1U;
+	size_t o = sizeof(uint64_t);
+
+	for (size_t i = 0U; i <= nflds && o + sizeof(uint64_t) <= b.z; i++) {
+		const size_t wid =
+			i ? _layo_wid(flds[i - 1U]) : sizeof(cots_to_t);
+		uint64_t tz;
+
+		memcpy(&tz, b.data + o, sizeof(tz));
+		tz = be64toh(tz);
+		o += sizeof(tz) + (tz >> 8U);
+		__atomic_fetch_add(rawz + i, nrows * wid, __ATOMIC_RELAXED);
+		__atomic_fetch_add(
+			compz + i, sizeof(tz) + (tz >> 8U), __ATOMIC_RELAXED);
+	}
+	__atomic_fetch_add(&st->pub.nticks, nrows, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&st->pub.npages, 1U, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&st->pub.pagez, b.z, __ATOMIC_RELAXED);
+	return;
+}
+
 static struct blob_s
-_make_blob(
+_comp_blob(
 	const char *flds, size_t nflds,
-	const struct cots_wal_s *src, struct cots_wal_s *restrict tmp)
+	const struct cots_tsoa_s *cols, size_t nrows, int bdir)
 {
-	const size_t blkz = src->blkz;
-	struct {
-		struct cots_tsoa_s proto;
-		void *cols[nflds];
-		cots_to_t from;
-		cots_to_t till;
-	} cols;
+/* compact NROWS ticks in COLS into a page */
+	const cots_to_t from = cols->toffs[0U];
+	const cots_to_t till = cols->toffs[nrows - 1U];
 	uint8_t *buf;
-	size_t nrows;
 	size_t bi;
 	size_t bsz;
 	uint64_t z;
 
-	if (UNLIKELY(!(nrows = _wal_rowi(src)))) {
-		/* trivial */
-		return (struct blob_s){0U, NULL};
-	}
-
 	/* trial mmap, fair estimate would be to use nrows * nflds * uint64_t
 	 * and then time 2 for the compressed data as well */
 	bi = sizeof(uint64_t) * (nflds + 1U) * (nrows > 64U ? nrows : 64U);
@@ -404,22 +892,8 @@ _make_blob(
 		return (struct blob_s){0U, NULL};
 	}
 
-	/* imprint standard layout on COLS tsoa using mwal's buffer */
-	cols.proto.toffs = (void*)tmp->data;
-	for (size_t i = 0U, a = _layo_zrow(flds, i), wid; i < nflds;
-	     wid = _layo_wid(flds[i]), a += wid, a = _layo_algn(a, wid), i++) {
-		cols.cols[i] = tmp->data + blkz * a;
-	}
-	/* call the columnifier */
-	_bang_tick(&cols.proto, src->data, nrows, flds, nflds, _wal_rowi(tmp));
-	_wal_rset(tmp, nrows);
-
-	/* get from and till values */
-	cols.from = cols.proto.toffs[0U];
-	cols.till = cols.proto.toffs[nrows - 1U];
-
 	/* call the compactor */
-	z = comp(buf + sizeof(z), nflds, nrows, flds, &cols.proto);
+	z = comp(buf + sizeof(z), nflds, nrows, flds, cols, bdir);
 	/* store compacted size and number of rows
 	 * seeing as the maximum blocksize can be 2^24 and storing 0 rows
 	 * would not be beneficial we store nrows-1 in the first 24bits
@@ -444,13 +918,39 @@ _make_blob(
 		}
 		buf = blo;
 	}
-	return (struct blob_s){z, buf, cols.from, cols.till};
+	return (struct blob_s){z, buf, from, till};
 
 mun_out:
 	munmap(buf, bsz);
 	return (struct blob_s){0U, NULL};
 }
 
+static struct blob_s
+_make_blob(
+	const char *flds, size_t nflds,
+	const struct cots_wal_s *src, struct cots_wal_s *restrict tmp, int bdir)
+{
+	const size_t blkz = src->blkz;
+	struct {
+		struct cots_tsoa_s proto;
+		void *cols[nflds];
+	} cols;
+	size_t nrows;
+
+	if (UNLIKELY(!(nrows = _wal_rowi(src)))) {
+		/* trivial */
+		return (struct blob_s){.z = 0U, .data = NULL};
+	}
+
+	/* imprint standard layout on COLS tsoa using mwal's buffer */
+	_layo_impr(&cols.proto, tmp->data, flds, nflds, blkz);
+	/* call the columnifier */
+	_bang_tick(&cols.proto, src->data, nrows, flds, nflds, _wal_rowi(tmp));
+	_wal_rset(tmp, nrows);
+
+	return _comp_blob(flds, nflds, &cols.proto, nrows, bdir);
+}
+
 static void
 _free_blob(struct blob_s b)
 {
@@ -522,6 +1022,8 @@ _rd_meta_chnk(const uint8_t *chnk, size_t chnz)
 
 /* file fiddling */
 static int _bang_fields(struct _ss_s *_s, const char *flds, size_t fldz);
+static int _bang_rlps(struct _ss_s *_s, const uint8_t *rd, size_t rdz);
+static int _add_pgd(struct _ss_s *_s, struct pgde_s e, const void *zon);
 
 static int
 _updt_hdr(const struct _ss_s *_s, size_t metaz)
@@ -532,6 +1034,10 @@ _updt_hdr(const struct _ss_s *_s, size_t metaz)
 	}
 	_s->mdr->moff = htobe64(_s->fo);
 	_s->mdr->noff = htobe64(_s->fo + metaz);
+	/* any page in flight has landed now */
+	with (uint64_t fl = be64toh(_s->mdr->flags) & ~FHDR_INFL) {
+		__atomic_store_n(&_s->mdr->flags, htobe64(fl), __ATOMIC_RELEASE);
+	}
 	msync_any(_s->mdr, 0U, _hdrz(_s), MS_ASYNC);
 	return 0;
 }
@@ -574,6 +1080,26 @@ _wr_meta(const struct _ss_s *_s)
 		}
 		res += nwr;
 	}
+
+	if (_s->nrlp && _s->rlp->r.end) {
+		/* rollup directory, only once they've been placed by freeze */
+		uint64_t rd[3U * _s->nrlp];
+		ssize_t nwr;
+
+		for (size_t k = 0U; k < _s->nrlp; k++) {
+			rd[3U * k + 0U] = htobe64(_s->rlp[k].ival);
+			rd[3U * k + 1U] = htobe64(_s->rlp[k].r.beg);
+			rd[3U * k + 2U] = htobe64(_s->rlp[k].r.end);
+		}
+		nwr = _wr_meta_chnk(
+			_s->fd, (struct chnk_s){(uint8_t*)rd, sizeof(rd), 'R'});
+
+		if (UNLIKELY(nwr < 0)) {
+			/* truncate back to old size */
+			goto tru_out;
+		}
+		res += nwr;
+	}
 	return res;
 
 tru_out:
@@ -581,6 +1107,30 @@ tru_out:
 	return 0U;
 }
 
+static size_t
+_meta_z(const struct _ss_s *_s)
+{
+/* size of the meta section as _wr_meta() would write it */
+	size_t res = 0U;
+
+	if (_s->fields) {
+		const size_t nflds = _s->public.nfields;
+		const char *_1st = _s->public.fields[0U];
+		const char *last = _s->public.fields[nflds - 1U];
+
+		res += sizeof(uint64_t) + (last - _1st + strlen(last) + 1U);
+	}
+	if (_s->ob != NULL) {
+		const uint8_t *tgt;
+
+		res += sizeof(uint64_t) + wr_ob(&tgt, _s->ob);
+	}
+	if (_s->nrlp && _s->rlp->r.end) {
+		res += sizeof(uint64_t) + 3U * sizeof(uint64_t) * _s->nrlp;
+	}
+	return res;
+}
+
 static int
 _rd_meta(struct _ss_s *restrict _s)
 {
@@ -620,6 +1170,11 @@ _rd_meta(struct _ss_s *restrict _s)
 			_bang_fields(_s, (const char*)c.data, c.z);
 			break;
 
+		case 'R':
+			/* rollups, splendid */
+			_bang_rlps(_s, c.data, c.z);
+			break;
+
 		case 'O':
 			/* obarray, fantastic */
 			with (cots_ob_t nuob = rd_ob(c.data, c.z)) {
@@ -641,39 +1196,181 @@ _rd_meta(struct _ss_s *restrict _s)
 	return (c.data != NULL) - 1;
 }
 
-static int
-_flush(struct _ss_s *_s)
+static void
+_rlp_emit(struct rlp_s *r)
 {
-/* compact WAL and write contents to backing file */
-	const size_t nflds = _s->public.nfields;
-	const char *const layo = _s->public.layout;
-	size_t rowi;
-	struct blob_s b;
-	size_t mz;
-	int rc = 0;
+/* write R's bar to its companion series */
+	const struct rlpt_s t = {
+		{r->b.bt}, r->b.o, r->b.h, r->b.l, r->b.c, r->b.v
+	};
 
-	if (UNLIKELY(_s->wal == NULL)) {
-		return 0;
-	} else if (UNLIKELY(!(rowi = _wal_rowi(_s->wal)))) {
-		return 0;
-	} else if (UNLIKELY(_s->fd < 0)) {
-		rc = -1;
-		goto rst_out;
+	(void)cots_write_tick(r->ts, &t.proto);
+	r->b.nb = 0U;
+	return;
+}
+
+static void
+_rlp_feed(struct _ss_s *_s, const struct cots_tsoa_s *cols, size_t nt)
+{
+/* fold NT columnised ticks into the bars of all rollups,
+ * bars whose interval is over go to the companion series */
+	const size_t nflds = _s->public.nfields;
+	const char *layo = _s->public.layout;
+	const cots_px_t *px = NULL;
+	const cots_qx_t *qx = NULL;
+
+	/* first price and first quantity field, like resampling */
+	for (size_t i = 0U; i < nflds; i++) {
+		if (layo[i] == COTS_LO_PRC && px == NULL) {
+			px = cols->cols[i];
+		} else if (layo[i] == COTS_LO_QTY && qx == NULL) {
+			qx = cols->cols[i];
+		}
 	}
+	for (size_t k = 0U; k < _s->nrlp; k++) {
+		struct rlp_s *r = _s->rlp + k;
 
-	/* get ourselves a blob first */
-	b = _make_blob(layo, nflds, _s->wal, _s->mwal);
+		for (size_t i = _s->rlpt; i < nt; i++) {
+			/* bars start at multiples of IVAL */
+			const cots_to_t bt = cols->toffs[i] / r->ival * r->ival;
 
-	if (UNLIKELY(b.data == NULL)) {
-		/* blimey */
-		return -1;
+			if (r->b.nb && bt != r->b.bt) {
+				_rlp_emit(r);
+			}
+			if (!r->b.nb) {
+				_bar_new(&r->b, bt);
+			}
+			_bar_add(&r->b, px, qx, i);
+		}
+	}
+	_s->rlpt = 0U;
+	return;
+}
+
+/* group commit, fdatasync(2)s shared by all series of the process */
+static struct {
+	pthread_mutex_t mtx;
+	pthread_cond_t cnd;
+	/* batch collecting descriptors, last batch synced, last one failed */
+	uint64_t open;
+	uint64_t done;
+	uint64_t fail;
+	int busy;
+	/* descriptors of the open batch */
+	size_t nfd;
+	size_t zfd;
+	int *fd;
+} gc = {
+	.mtx = PTHREAD_MUTEX_INITIALIZER,
+	.cnd = PTHREAD_COND_INITIALIZER,
+	.open = 1U,
+};
+
+static int
+_gc_sync(int fd)
+{
+/* have FD synced along with anyone else's waiting, whoever comes first
+ * syncs the lot while the others queue up for the next batch */
+	uint64_t e;
+	int rc;
+
+	pthread_mutex_lock(&gc.mtx);
+	for (size_t i = 0U; i < gc.nfd; i++) {
+		if (gc.fd[i] == fd) {
+			goto wait;
+		}
+	}
+	if (UNLIKELY(gc.nfd >= gc.zfd)) {
+		const size_t nuz = (gc.zfd * 2U) ?: 16U;
+		int *nu = realloc(gc.fd, nuz * sizeof(*gc.fd));
+
+		if (UNLIKELY(nu == NULL)) {
+			/* sync on our own then */
+			pthread_mutex_unlock(&gc.mtx);
+			return fdatasync(fd);
+		}
+		gc.fd = nu;
+		gc.zfd = nuz;
 	}
+	gc.fd[gc.nfd++] = fd;
+wait:
+	for (e = gc.open; gc.done < e;) {
+		if (gc.busy) {
+			pthread_cond_wait(&gc.cnd, &gc.mtx);
+			continue;
+		}
+		/* we lead this batch, and new comers go to the next one */
+		const size_t nfd = gc.nfd;
+		int fds[nfd];
+		int fail = 0;
+
+		memcpy(fds, gc.fd, nfd * sizeof(*fds));
+		gc.nfd = 0U;
+		gc.open++;
+		gc.busy = 1;
+		pthread_mutex_unlock(&gc.mtx);
+
+#if defined SYNC_FILE_RANGE_WRITE
+		/* get write-back going for all of them at once */
+		for (size_t i = 0U; i < nfd; i++) {
+			(void)sync_file_range(
+				fds[i], 0, 0, SYNC_FILE_RANGE_WRITE);
+		}
+#endif	/* SYNC_FILE_RANGE_WRITE */
+		for (size_t i = 0U; i < nfd; i++) {
+			fail |= fdatasync(fds[i]) < 0;
+		}
+
+		pthread_mutex_lock(&gc.mtx);
+		gc.fail = fail ? e : gc.fail;
+		gc.done = e;
+		gc.busy = 0;
+		pthread_cond_broadcast(&gc.cnd);
+	}
+	/* failures of later batches are reported too, better safe */
+	rc = -(gc.fail >= e);
+	pthread_mutex_unlock(&gc.mtx);
+	return rc;
+}
+
+static int
+_dur_wal(struct _ss_s *_s, size_t n)
+{
+/* N ticks went to the WAL, sync it if it's time */
+	struct dur_s *d = &_s->dur;
+	const struct cots_wal_s *w = _s->wal;
+	uint64_t now = 0U;
 
-	with (size_t uncomp = _s->wal->zrow * rowi) {
-		fprintf(stderr, "comp %zu  (%0.2f%%)\n",
-			b.z, 100. * (double)b.z / (double)uncomp);
+	d->nt += n;
+	if (d->n && d->nt >= d->n) {
+		;
+	} else if (d->usec && (now = _now_ns()) - d->last >= d->usec * 1000U) {
+		;
+	} else if (d->n || d->usec) {
+		/* not yet */
+		return 0;
 	}
+	d->nt = 0U;
+	d->last = now ?: d->usec ? _now_ns() : 0U;
+	return msync_any(deconst(w), 0, sizeof(*w) + _wal_rowi(w) * w->zrow,
+			 MS_SYNC);
+}
+
+static int
+_wr_page(struct _ss_s *_s, struct blob_s b,
+	 const struct cots_tsoa_s *cols, size_t nrows, uint64_t t0)
+{
+/* write page B of NROWS ticks, columnised in COLS, to the backing file
+ * and bring index, zone maps, rollups and meta data up to date,
+ * compaction of the page started at T0 */
+	const size_t nflds = _s->public.nfields;
+	const char *const layo = _s->public.layout;
+	const uint64_t t1 = _s->st ? _now_ns() : 0U;
+	size_t mz;
+	int rc = 0;
 
+	/* pages from here on are to be overwritten */
+	pcache_drop(_s->dev, _s->ino, _s->fo);
 	/* manifest blob in file */
 	(void)lseek(_s->fd, _s->fo, SEEK_SET);
 	/* simply write stuff */
@@ -683,10 +1380,22 @@ _flush(struct _ss_s *_s)
 		if (UNLIKELY(nwr < 0)) {
 			/* truncate back to old size */
 			(void)ftruncate(_s->fd, _s->fo);
-			rc = -1;
-			goto fre_out;
+			return -1;
 		}
 	}
+	if (_s->cw) {
+		/* the page moves from in flight to landed in one go */
+		pthread_mutex_lock(&_s->cw->mtx);
+		_s->cw->nt = 0U;
+	}
+	if (_s->st) {
+		_st_hist(&_s->st->pub.comp, t1 - t0);
+		_st_hist(&_s->st->pub.write, _now_ns() - t1);
+		_st_page(_s->st, b, layo, nflds, nrows);
+	}
+	if (_s->cw) {
+		pthread_mutex_unlock(&_s->cw->mtx);
+	}
 	/* devance read offset */
 	if (UNLIKELY(_s->ro > _s->fo)) {
 		_s->ro = _s->fo + b.z;
@@ -694,37 +1403,245 @@ _flush(struct _ss_s *_s)
 	/* advance file offset and celebrate */
 	_s->fo += b.z;
 
-	/* add to index */
-	if (_s->idx) {
-		cots_add_index(
-			_s->idx,
-			(struct trng_s){b.from, b.till},
-			(struct orng_s){_s->fo - b.z, _s->fo},
-			rowi);
+	/* zone maps, from the columnised ticks */
+	with (size_t zz = _zone_z(layo, nflds)) {
+		uint8_t zon[zz + !zz];
+
+		_zone_row(zon, cols, layo, nflds, nrows);
+		/* bring rollups up to date while the columns are at hand */
+		_rlp_feed(_s, cols, nrows);
+
+		/* add to index, older indices come without zone maps */
+		if (_s->idx) {
+			const size_t izz = _s->idx->nfields ==
+				2U + 2U * _zone_n(layo, nflds) ? zz : 0U;
+
+			cots_add_index(
+				_s->idx,
+				(struct trng_s){b.from, b.till},
+				(struct orng_s){_s->fo - b.z, _s->fo},
+				nrows, zon, izz);
+		}
+		/* keep page directory in sync, if it's been built already */
+		if (_s->pgd) {
+			_add_pgd(_s, (struct pgde_s){
+					 .from = b.from,
+					 .beg = _s->fo - b.z, .end = _s->fo,
+					 .nt = nrows},
+				 zon);
+		}
 	}
 
 	/* put stuff like field names, obarray, etc. into the meta section
 	 * this will not update the FO */
-	mz = _wr_meta(_s);
+	if (_s->cw) {
+		/* the obarray might be growing meanwhile */
+		pthread_mutex_lock(&_s->cw->mtx);
+		mz = _wr_meta(_s);
+		pthread_mutex_unlock(&_s->cw->mtx);
+	} else {
+		mz = _wr_meta(_s);
+	}
 
 	/* update header */
 	_updt_hdr(_s, mz);
 
-fre_out:
+	/* page, meta data and header go to disk together,
+	 * before the WAL, the only other copy of the ticks, is reused */
+	if (_s->dur.how & COTS_SYNC_GROUP) {
+		rc = _gc_sync(_s->fd);
+	} else if (_s->dur.how & (COTS_SYNC_PAGE | COTS_SYNC_WAL)) {
+		rc = fdatasync(_s->fd);
+	}
+
+	if (_s->st) {
+		_st_hist(&_s->st->pub.flush, _now_ns() - t0);
+	}
+	return rc;
+}
+
+static int
+_flush_wal(struct _ss_s *_s, struct cots_wal_s *w, struct cots_wal_s *m)
+{
+/* compact rows in W, using M for their columns,
+ * and write the page to the backing file */
+	const size_t nflds = _s->public.nfields;
+	const char *const layo = _s->public.layout;
+	struct {
+		struct cots_tsoa_s proto;
+		void *cols[nflds];
+	} cols;
+	size_t rowi;
+	struct blob_s b;
+	uint64_t t0;
+	int rc = 0;
+
+	if (UNLIKELY(w == NULL)) {
+		return 0;
+	} else if (UNLIKELY(!(rowi = _wal_rowi(w)))) {
+		return 0;
+	} else if (UNLIKELY(_s->fd < 0)) {
+		rc = -1;
+		goto rst_out;
+	}
+
+	/* get ourselves a blob first */
+	t0 = _s->st ? _now_ns() : 0U;
+	b = _make_blob(layo, nflds, w, m, _s->bdir);
+
+	if (UNLIKELY(b.data == NULL)) {
+		/* blimey */
+		return -1;
+	}
+
+	/* the blob's columns are in M now */
+	_layo_impr(&cols.proto, m->data, layo, nflds, _s->public.blockz);
+	rc = _wr_page(_s, b, &cols.proto, rowi, t0);
+
 	_free_blob(b);
 	/* keep last wal value */
-	with (uint64_t bak[nflds + 1U]) {
-		_wal_last(bak, _s->wal);
-		_wal_rset(_s->wal, -1ULL);
-		_wal_bang(_s->wal, bak);
-	}
+	_wal_keep(w);
 rst_out:
 	/* and reset both WALs */
+	_wal_rset(w, 0U);
+	_wal_rset(m, 0U);
+	/* the next rows go behind this page */
+	if (w == _s->wal) {
+		_wal_stamp(w, _s->fo, 0U);
+	} else if (_s->wal != NULL) {
+		/* page in flight landed, the writer's WAL goes behind it */
+		_s->wal->moff = _s->fo;
+	}
+	return rc;
+}
+
+
+/* asynchronous flushing */
+static int
+_cw_wait(struct _ss_s *_s)
+{
+/* wait for the page in flight, if any, return the first error */
+	struct cw_s *cw = _s->cw;
+	int rc;
+
+	if (cw == NULL) {
+		return 0;
+	}
+	pthread_mutex_lock(&cw->mtx);
+	while (cw->busy) {
+		pthread_cond_wait(&cw->cnd, &cw->mtx);
+	}
+	rc = cw->rc;
+	cw->rc = 0;
+	pthread_mutex_unlock(&cw->mtx);
+	return rc;
+}
+
+static void*
+_cw_work(void *clo)
+{
+/* flush pages handed over by the writer */
+	struct _ss_s *_s = clo;
+	struct cw_s *cw = _s->cw;
+
+	pthread_mutex_lock(&cw->mtx);
+	while (!cw->quit || cw->busy) {
+		int rc;
+
+		if (!cw->busy) {
+			pthread_cond_wait(&cw->cnd, &cw->mtx);
+			continue;
+		}
+		pthread_mutex_unlock(&cw->mtx);
+
+		/* W is ours until BUSY goes down */
+		rc = _flush_wal(_s, cw->w, cw->m);
+
+		pthread_mutex_lock(&cw->mtx);
+		cw->rc = cw->rc ?: rc;
+		cw->busy = 0;
+		pthread_cond_broadcast(&cw->cnd);
+	}
+	pthread_mutex_unlock(&cw->mtx);
+	return NULL;
+}
+
+static int
+_cw_hand(struct _ss_s *_s)
+{
+/* hand the full WAL over to the worker and carry on with an empty one */
+	struct cw_s *cw = _s->cw;
+	/* there's only ever one page in flight */
+	int rc = _cw_wait(_s);
+
+	_wal_copy(cw->w, _s->wal);
+	if (_s->mdr != NULL) {
+		/* tell followers that the WAL's no longer the page at moff */
+		uint64_t fl = be64toh(_s->mdr->flags) | FHDR_INFL;
+
+		__atomic_store_n(&_s->mdr->flags, htobe64(fl), __ATOMIC_RELAXED);
+		__atomic_thread_fence(__ATOMIC_RELEASE);
+	}
+	_wal_keep(_s->wal);
 	_wal_rset(_s->wal, 0U);
 	_wal_rset(_s->mwal, 0U);
+	/* should we crash the page in flight is lost, replay what's after */
+	_wal_stamp(_s->wal, _s->fo, 0U);
+
+	pthread_mutex_lock(&cw->mtx);
+	cw->busy = 1;
+	cw->nt = _wal_rowi(cw->w);
+	pthread_cond_signal(&cw->cnd);
+	pthread_mutex_unlock(&cw->mtx);
+	return rc;
+}
+
+static void
+_cw_free(struct cw_s *cw)
+{
+	if (cw->w != NULL) {
+		_free_wal(cw->w);
+	}
+	if (cw->m != NULL) {
+		_free_wal(cw->m);
+	}
+	free(cw);
+	return;
+}
+
+static int
+_cw_stop(struct _ss_s *_s)
+{
+/* flush what's in flight and retire the worker */
+	struct cw_s *cw = _s->cw;
+	int rc;
+
+	if (cw == NULL) {
+		return 0;
+	}
+	pthread_mutex_lock(&cw->mtx);
+	cw->quit = 1;
+	pthread_cond_broadcast(&cw->cnd);
+	pthread_mutex_unlock(&cw->mtx);
+	pthread_join(cw->th, NULL);
+	rc = cw->rc;
+
+	pthread_cond_destroy(&cw->cnd);
+	pthread_mutex_destroy(&cw->mtx);
+	_s->cw = NULL;
+	_cw_free(cw);
 	return rc;
 }
 
+static int
+_flush(struct _ss_s *_s)
+{
+/* compact WAL and write contents to backing file */
+	int rc = _cw_wait(_s);
+
+	return _flush_wal(_s, _s->wal, _s->mwal) ?: rc;
+}
+
 static ssize_t
 _cat(struct _ss_s *restrict _s, const struct cots_ss_s *src)
 {
@@ -763,16 +1680,157 @@ tru_out:
 	return -1;
 }
 
+static const uint8_t*
+_rd_dio(struct rwin_s *w, off_t o, size_t z)
+{
+/* like _rd_map() but read DWINZ octets at a time past the page cache,
+ * direct reads need the offset, size and buffer aligned */
+	const off_t ao = o & ~(off_t)(DALGN - 1U);
+	const size_t az = (o - ao + z + DALGN - 1U) & ~(size_t)(DALGN - 1U);
+	ssize_t nrd;
+
+	if (LIKELY(w->p != NULL && o >= w->o && o + z <= w->o + w->z)) {
+		return w->p + (o - w->o);
+	} else if (UNLIKELY(az > w->dbz)) {
+		/* page larger than the window, make room */
+		void *nu;
+
+		if (UNLIKELY(posix_memalign(&nu, DALGN, az))) {
+			return NULL;
+		}
+		free(w->dbuf);
+		w->dbuf = nu;
+		w->dbz = az;
+	}
+	/* slide, reading ahead as much as fits */
+	w->p = NULL;
+	nrd = pread(w->dfd, w->dbuf, w->dbz, ao);
+	if (UNLIKELY(nrd < (ssize_t)(o - ao + z))) {
+		return NULL;
+	}
+	w->p = w->dbuf;
+	w->o = ao;
+	w->z = nrd;
+	return w->p + (o - ao);
+}
+
+static const uint8_t*
+_rd_map(struct rwin_s *w, int fd, off_t o, size_t z)
+{
+/* return a pointer to Z octets at offset O of the backing file
+ * instead of mapping pages one by one we keep one large window
+ * and only slide it when O+Z falls outside */
+	const size_t pgsz = mmap_pgsz();
+	uint8_t *p;
+
+	if (w->dbuf != NULL) {
+		/* we're reading directly */
+		return _rd_dio(w, o, z);
+	} else if (LIKELY(w->p != NULL && o >= w->o && o + z <= w->o + w->z)) {
+		return w->p + (o - w->o);
+	} else if (w->p != NULL) {
+		munmap(deconst(w->p), w->z);
+		w->p = NULL;
+	}
+	/* slide */
+	w->o = o - o % pgsz;
+	w->z = max_z(RMAPZ, z + o % pgsz);
+	p = mmap(NULL, w->z, PROT_READ, MAP_SHARED, fd, w->o);
+	if (UNLIKELY(p == MAP_FAILED)) {
+		return NULL;
+	}
+	/* we're mostly scanning */
+	(void)madvise(p, w->z, MADV_SEQUENTIAL);
+	w->p = p;
+	return p + o % pgsz;
+}
+
+static void
+_rd_init(struct rwin_s *w, const struct _ss_s *_s)
+{
+/* set up read window W, reading directly if _S does */
+	void *buf;
+
+	*w = (struct rwin_s){NULL};
+	if (_s->dfd >= 0 && !posix_memalign(&buf, DALGN, DWINZ)) {
+		w->dbuf = buf;
+		w->dbz = DWINZ;
+		w->dfd = _s->dfd;
+	}
+	return;
+}
+
+static void
+_rd_unmap(struct rwin_s *w)
+{
+	if (w->dbuf != NULL) {
+		free(w->dbuf);
+		w->dbuf = NULL;
+		w->p = NULL;
+	} else if (w->p != NULL) {
+		munmap(deconst(w->p), w->z);
+		w->p = NULL;
+	}
+	return;
+}
+
+static void
+_rd_want(struct _ss_s *_s, off_t o, size_t z)
+{
+/* announce that Z octets at offset O will be read soon */
+	const size_t pgsz = mmap_pgsz();
+	const uint8_t *p;
+	size_t ofp;
+
+	if (_s->rw.dbuf != NULL) {
+		/* direct reads bring their own read-ahead */
+		return;
+	} else if (UNLIKELY((p = _rd_map(&_s->rw, _s->fd, o, 0U)) == NULL)) {
+		return;
+	}
+	/* page-align and clip to window */
+	ofp = (p - _s->rw.p) & ~(pgsz - 1U);
+	z = min_z(z + (p - _s->rw.p) - ofp, _s->rw.z - ofp);
+	(void)madvise(deconst(_s->rw.p + ofp), z, MADV_WILLNEED);
+	return;
+}
+
+static size_t
+_dcmp_pag(struct cots_tsoa_s *restrict tgt, const struct _ss_s *_s,
+	  const uint8_t *c, size_t cz, size_t nrows, size_t rt)
+{
+/* decompress the CZ octets of page cells at C holding NROWS ticks,
+ * output the ticks from row RT onwards, return their number or 0 */
+	const size_t nflds = _s->public.nfields;
+	const char *layo = _s->public.layout;
+	const uint64_t t0 = _s->st ? _now_ns() : 0U;
+	size_t nt;
+
+	if (rt) {
+		/* start at the block containing RT */
+		nt = dcmp_from(tgt, nflds, nrows, layo, c, cz, rt);
+	} else {
+		nt = dcmp(tgt, nflds, nrows, layo, c, cz);
+	}
+	if (_s->st) {
+		_st_hist(&_s->st->pub.dcmp, _now_ns() - t0);
+	}
+	return nt == nrows - rt ? nt : 0U;
+}
+
 static ssize_t
-_rd_cpag(struct cots_tsoa_s *restrict tgt,
-	 const int fd, off_t *restrict o, const size_t z,
-	 const char *layo, size_t nflds)
+_rd_cpag_r(struct cots_tsoa_s *restrict tgt, const struct _ss_s *_s,
+	   struct rwin_s *w, off_t *restrict o, const size_t z, size_t rt)
 {
+/* decompress page at offset O, the page must not exceed Z octets,
+ * use read window W, output rows from RT onwards */
+	const size_t nflds = _s->public.nfields;
+	const char *layo = _s->public.layout;
 	const uint8_t *p;
 	size_t nrows;
 	size_t rz;
 
-	p = mmap_any(fd, PROT_READ, MAP_SHARED, *o, z);
+	p = _rd_map(w, _s->fd, *o, sizeof(uint64_t));
 	if (UNLIKELY(p == NULL)) {
 		/* don't bother updating offset either */
 		return -1;
@@ -780,7 +1838,10 @@ _rd_cpag(struct cots_tsoa_s *restrict tgt,
 
 	/* quickly inspect integrity, well update RO more importantly */
 	with (uint64_t zn) {
+		size_t wid[nflds];
+		struct pkey_s k;
 		size_t ntdcmp;
+		ssize_t ntc;
 
 		memcpy(&zn, p, sizeof(zn));
 		zn = be64toh(zn);
@@ -788,73 +1849,348 @@ _rd_cpag(struct cots_tsoa_s *restrict tgt,
 		nrows = (zn & 0xffffffU) + 1U;
 		rz = zn >> 24U;
 
-		if (UNLIKELY(rz > z)) {
-			/* more space than is mapped? */
+		if (UNLIKELY(sizeof(zn) + rz > z)) {
+			/* page exceeds its boundaries? */
 			nrows = 0U;
 			rz = 0U;
 			break;
 		}
+		/* someone might have decoded this page already */
+		for (size_t i = 0U; i < nflds; i++) {
+			wid[i] = _layo_wid(layo[i]);
+		}
+		k = (struct pkey_s){_s->dev, _s->ino, *o, zn};
+		if (rt) {
+			/* partial pages don't go through the cache */
+			;
+		} else if ((ntc = pcache_get(tgt, k, wid, nflds)) >= 0) {
+			nrows = ntc;
+			rz += 2U * sizeof(zn);
+			break;
+		}
+		/* make sure the whole page is in the window */
+		p = _rd_map(w, _s->fd, *o, sizeof(zn) + rz);
+		if (UNLIKELY(p == NULL)) {
+			return -1;
+		}
+		if (_s->st && w->dbuf != NULL) {
+			__atomic_fetch_add(
+				&_s->st->pub.ndirect, 1U, __ATOMIC_RELAXED);
+		}
 		/* decompress */
-		ntdcmp = dcmp(tgt, nflds, nrows, layo, p + sizeof(zn), rz);
-		if (UNLIKELY(ntdcmp != nrows)) {
+		ntdcmp = _dcmp_pag(tgt, _s, p + sizeof(zn), rz, nrows, rt);
+		if (UNLIKELY(!ntdcmp)) {
 			nrows = 0U;
 			rz = 0U;
 			break;
+		} else if (!rt) {
+			pcache_put(k, tgt, nrows, wid, nflds);
 		}
-
+		nrows = ntdcmp;
 		rz += 2U * sizeof(zn);
 	}
 
-	/* unmap */
-	munmap_any(deconst(p), *o, z);
-	/* and update offset */
+	/* update offset */
 	*o += rz;
 	return nrows;
 }
 
-static size_t
-_rd_layo(const char **layo, int fd, off_t at)
+static inline ssize_t
+_rd_cpag_w(struct cots_tsoa_s *restrict tgt, const struct _ss_s *_s,
+	   struct rwin_s *w, off_t *restrict o, const size_t z)
 {
-	size_t lz, li = 0U;
-	char *lp;
+	return _rd_cpag_r(tgt, _s, w, o, z, 0U);
+}
 
-	/* start out with a conservative 7 fields */
-	if (UNLIKELY((lp = malloc(lz = 8U)) == NULL)) {
-		return 0U;
-	}
-	while (1) {
-		ssize_t nrd = pread(fd, lp + li, lz - li, at + li);
-		const char *eo;
+static inline ssize_t
+_rd_cpag(struct cots_tsoa_s *restrict tgt,
+	 struct _ss_s *_s, off_t *restrict o, const size_t z)
+{
+	return _rd_cpag_w(tgt, _s, &_s->rw, o, z);
+}
 
-		if (UNLIKELY(nrd <= 0)) {
-			/* no luck whatsoever */
-			goto nul_out;
-		} else if ((eo = memchr(lp + li, '\0', nrd)) != NULL) {
-			li = eo - lp;
-			break;
+static void*
+_pf_work(void *clo)
+{
+/* read-ahead worker, decode pages into the ring until it's full */
+	struct _ss_s *_s = clo;
+	struct pf_s *pf = _s->pf;
+
+	pthread_mutex_lock(&pf->mtx);
+	while (!pf->quit) {
+		struct pfsl_s *sl;
+		off_t o, no, eo;
+		size_t gen;
+		ssize_t nt;
+
+		if (pf->tail - pf->head >= pf->nsl || pf->o >= pf->eo) {
+			/* ring's full or nothing to do */
+			pthread_cond_wait(&pf->cnd, &pf->mtx);
+			continue;
 		}
-		/* otherwise double in size and retry */
-		li += nrd;
-		lp = realloc(lp, lz *= 2U);
+		sl = pf->sl + pf->tail % pf->nsl;
+		no = o = pf->o;
+		eo = pf->eo;
+		gen = pf->gen;
+		pthread_mutex_unlock(&pf->mtx);
+
+		/* slot's ours, no one looks at it until TAIL moves */
+		nt = _rd_cpag_w(sl->t, _s, &pf->rw, &no, eo - o);
+
+		pthread_mutex_lock(&pf->mtx);
+		if (UNLIKELY(gen != pf->gen)) {
+			/* repositioned meanwhile */
+			continue;
+		}
+		sl->o = o;
+		sl->no = no;
+		sl->nt = nt;
+		pf->tail++;
+		/* don't go past broken pages */
+		pf->o = nt > 0 ? no : pf->eo;
+		pthread_cond_broadcast(&pf->cnd);
 	}
-	/* very good, count and assign */
-	*layo = lp;
-	return li;
+	pthread_mutex_unlock(&pf->mtx);
+	_rd_unmap(&pf->rw);
+	return NULL;
+}
 
-nul_out:
-	free(lp);
-	return 0U;
+static void
+_pf_free(struct pf_s *pf, cots_ts_t s)
+{
+	for (size_t i = 0U; i < pf->nsl && pf->sl[i].t; i++) {
+		cots_fini_tsoa(pf->sl[i].t, s);
+		free(pf->sl[i].t);
+	}
+	free(pf);
+	return;
 }
 
-static cots_ts_t
-_open_core(int fd, struct orng_s r)
+static void
+_pf_stop(struct _ss_s *_s)
 {
-/* treat range R.BEG till R.END as cots_ts and try and open it */
-	struct _ss_s *res;
-	struct fhdr_s hdr;
-	const char *layo;
+	struct pf_s *pf = _s->pf;
+
+	if (pf == NULL) {
+		return;
+	}
+	pthread_mutex_lock(&pf->mtx);
+	pf->quit = 1;
+	pthread_cond_broadcast(&pf->cnd);
+	pthread_mutex_unlock(&pf->mtx);
+	pthread_join(pf->th, NULL);
+
+	pthread_cond_destroy(&pf->cnd);
+	pthread_mutex_destroy(&pf->mtx);
+	_pf_free(pf, &_s->public);
+	_s->pf = NULL;
+	return;
+}
+
+static ssize_t
+_pf_read(struct cots_tsoa_s *restrict tgt, struct _ss_s *_s)
+{
+/* hand out the read-ahead page at _S->RO, return -1 if there is none */
+	const size_t nflds = _s->public.nfields;
+	const char *layo = _s->public.layout;
+	struct pf_s *pf = _s->pf;
+	struct pfsl_s sl;
+
+	pthread_mutex_lock(&pf->mtx);
+	if (pf->head < pf->tail
+	    ? pf->sl[pf->head % pf->nsl].o != _s->ro
+	    : pf->o != _s->ro || pf->eo != _s->fo) {
+		/* caller went elsewhere, reposition worker */
+		pf->gen++;
+		pf->head = pf->tail = 0U;
+		pf->o = _s->ro;
+		pf->eo = _s->fo;
+		pthread_cond_broadcast(&pf->cnd);
+	}
+	while (pf->head >= pf->tail && pf->o < pf->eo) {
+		pthread_cond_wait(&pf->cnd, &pf->mtx);
+	}
+	if (UNLIKELY(pf->head >= pf->tail)) {
+		pthread_mutex_unlock(&pf->mtx);
+		return -1;
+	}
+	sl = pf->sl[pf->head % pf->nsl];
+	pthread_mutex_unlock(&pf->mtx);
+
+	if (UNLIKELY(sl.nt <= 0)) {
+		/* leave it to the caller */
+		return -1;
+	}
+	/* copy the page over */
+	memcpy(tgt->toffs, sl.t->toffs, sl.nt * sizeof(*tgt->toffs));
+	for (size_t i = 0U; i < nflds; i++) {
+		if (tgt->cols[i] == NULL) {
+			/* not projected */
+			continue;
+		}
+		memcpy(tgt->cols[i], sl.t->cols[i], sl.nt * _layo_wid(layo[i]));
+	}
+	_s->ro = sl.no;
+
+	/* free the slot */
+	pthread_mutex_lock(&pf->mtx);
+	pf->head++;
+	pthread_cond_broadcast(&pf->cnd);
+	pthread_mutex_unlock(&pf->mtx);
+	return sl.nt;
+}
+
+static const struct cots_wal_s*
+_flw_wal(const struct _ss_s *_s)
+{
+/* map the WAL of the writer of our file, if there's one */
+	const size_t blkz = _s->public.blockz;
+	const size_t zrow = _layo_zrow(_s->public.layout, _s->public.nfields);
+	const size_t fz = sizeof(struct cots_wal_s) + blkz * zrow;
+	char walfn[WALFN_Z(_s->public.filename)];
+	const struct cots_wal_s *w;
+	struct stat st;
+	int fd;
+
+	_wal_fn(walfn, _s->public.filename);
+	if ((fd = open(walfn, O_RDONLY)) < 0) {
+		return NULL;
+	} else if (UNLIKELY(fstat(fd, &st) < 0 || (size_t)st.st_size < fz)) {
+		close(fd);
+		return NULL;
+	}
+	w = mmap(NULL, fz, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (UNLIKELY(w == MAP_FAILED)) {
+		return NULL;
+	} else if (UNLIKELY(memcmp(w->magic, "cots", 4U) ||
+			    w->blkz != blkz || w->zrow != zrow)) {
+		/* not one of ours */
+		munmap(deconst(w), fz);
+		return NULL;
+	}
+	return w;
+}
+
+static void
+_flw_unwal(struct _ss_s *_s)
+{
+	if (_s->fwal != NULL) {
+		const size_t fz = sizeof(*_s->fwal) +
+			_s->fwal->blkz * _s->fwal->zrow;
+
+		munmap(deconst(_s->fwal), fz);
+		_s->fwal = NULL;
+	}
+	return;
+}
+
+static off_t
+_flw_fo(struct _ss_s *_s)
+{
+/* pick up pages the writer has flushed since */
+	const uint64_t moff =
+		__atomic_load_n(&_s->mdr->moff, __ATOMIC_ACQUIRE);
+
+	if (moff && (off_t)be64toh(moff) > _s->fo) {
+		_s->fo = be64toh(moff);
+	}
+	return _s->fo;
+}
+
+static int
+_flw_infl(const struct _ss_s *_s)
+{
+/* whether the writer has a page in flight */
+	const uint64_t fl =
+		__atomic_load_n(&_s->mdr->flags, __ATOMIC_ACQUIRE);
+
+	return !!(be64toh(fl) & FHDR_INFL);
+}
+
+static ssize_t
+_flw_read(struct cots_tsoa_s *restrict tgt, struct _ss_s *_s)
+{
+/* read ticks past _S->RT from the followed writer's WAL
+ * return 0 if there's none or if new pages came in instead */
+	const size_t nflds = _s->public.nfields;
+	const char *layo = _s->public.layout;
+
+	for (off_t fo; (fo = _flw_fo(_s)) <= _s->ro;) {
+		const struct cots_wal_s *w;
+		size_t n;
+
+		if ((w = _s->fwal) == NULL &&
+		    (w = _s->fwal = _flw_wal(_s)) == NULL) {
+			/* no writer yet */
+			return 0;
+		} else if (_flw_infl(_s)) {
+			/* WAL's ahead of the pages, wait for them */
+			return 0;
+		}
+		n = __atomic_load_n(&w->rowi, __ATOMIC_ACQUIRE);
+		if (n <= _s->rt || n > w->blkz) {
+			return 0;
+		}
+		_bang_tick(tgt, w->data + _s->rt * w->zrow, n - _s->rt,
+			   layo, nflds, 0U);
+		/* the writer flushes and updates the header before it
+		 * reuses its WAL, or flags the page it hands off to be
+		 * flushed, so an unchanged header means we're good */
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if (_flw_fo(_s) == fo && !_flw_infl(_s)) {
+			n -= _s->rt;
+			_s->rt += n;
+			return n;
+		}
+	}
+	return 0;
+}
+
+static size_t
+_rd_layo(const char **layo, int fd, off_t at)
+{
+	size_t lz, li = 0U;
+	char *lp;
+
+	/* start out with a conservative 7 fields */
+	if (UNLIKELY((lp = malloc(lz = 8U)) == NULL)) {
+		return 0U;
+	}
+	while (1) {
+		ssize_t nrd = pread(fd, lp + li, lz - li, at + li);
+		const char *eo;
+
+		if (UNLIKELY(nrd <= 0)) {
+			/* no luck whatsoever */
+			goto nul_out;
+		} else if ((eo = memchr(lp + li, '\0', nrd)) != NULL) {
+			li = eo - lp;
+			break;
+		}
+		/* otherwise double in size and retry */
+		li += nrd;
+		lp = realloc(lp, lz *= 2U);
+	}
+	/* very good, count and assign */
+	*layo = lp;
+	return li;
+
+nul_out:
+	free(lp);
+	return 0U;
+}
+
+static cots_ts_t
+_open_core(int fd, struct orng_s r)
+{
+/* treat range R.BEG till R.END as cots_ts and try and open it */
+	struct _ss_s *res;
+	struct fhdr_s hdr;
+	const char *layo;
 	size_t nflds;
 	size_t blkz;
+	int bdir;
 
 	if (UNLIKELY(r.end - r.beg < (ssize_t)sizeof(*res->mdr))) {
 		return NULL;
@@ -870,6 +2206,7 @@ _open_core(int fd, struct orng_s r)
 	/* read block size */
 	with (uint64_t hfl = be64toh(hdr.flags)) {
 		blkz = exp_lgbz(hfl & 0xfU);
+		bdir = !!(hfl & FHDR_BDIR);
 	}
 	/* snarf the layout and calculate zrow size */
 	nflds = _rd_layo(&layo, fd, r.beg + sizeof(hdr));
@@ -900,8 +2237,17 @@ _open_core(int fd, struct orng_s r)
 	/* collect details about this backing file */
 	res->fd = fd;
 	res->fl = O_RDONLY;
+	res->dfd = -1;
+	with (struct stat st) {
+		if (LIKELY(fstat(fd, &st) == 0)) {
+			res->dev = st.st_dev;
+			res->ino = st.st_ino;
+		}
+	}
 	res->fo = r.beg + be64toh(res->mdr->moff) ?: r.end;
 	res->ro = r.beg + _hdrz(res);
+	res->bo = r.beg;
+	res->bdir = bdir;
 
 	/* short dip into the meta pool */
 	(void)_rd_meta(res);
@@ -946,10 +2292,9 @@ _yank_rng(const char *fn, int fd, struct orng_s r)
 }
 
 static int
-_open_idx(struct _ss_s *_s, off_t eo)
+_open_idx(struct _ss_s *_s, struct orng_s at)
 {
-	struct orng_s at = {0, eo};
-
+/* open the index chain of _S, a series occupying AT */
 	do {
 		off_t noff = be64toh(_s->mdr->noff);
 
@@ -1002,6 +2347,349 @@ _next_pg(int fd, off_t at)
 	return (struct pagf_s){at, at + z + sizeof(uint64_t), b};
 }
 
+static size_t
+_lbnd_to(const cots_to_t *tv, size_t n, cots_to_t t)
+{
+/* return the index of the first element in sorted TV not before T */
+	size_t lo = 0U, hi = n;
+
+	while (lo < hi) {
+		const size_t mid = (lo + hi) / 2U;
+
+		if (tv[mid] < t) {
+			lo = mid + 1U;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+
+/* page directory */
+static int
+_add_pgd(struct _ss_s *_s, struct pgde_s e, const void *zon)
+{
+	const size_t zz = _zone_z(_s->public.layout, _s->public.nfields);
+
+	if (UNLIKELY(_s->npgd >= _s->zpgd)) {
+		const size_t nuz = _s->zpgd * 2U ?: 64U;
+		struct pgde_s *nu = realloc(_s->pgd, nuz * sizeof(*nu));
+
+		if (UNLIKELY(nu == NULL)) {
+			return -1;
+		}
+		_s->pgd = nu;
+		if (zz) {
+			uint8_t *zu = realloc(_s->zon, nuz * zz);
+
+			if (UNLIKELY(zu == NULL)) {
+				return -1;
+			}
+			_s->zon = zu;
+		}
+		_s->zpgd = nuz;
+	}
+	if ((e.zoned = zon != NULL && zz)) {
+		memcpy(_s->zon + _s->npgd * zz, zon, zz);
+	}
+	_s->pgd[_s->npgd++] = e;
+	return 0;
+}
+
+static size_t
+_find_pgd(const struct _ss_s *_s, cots_to_t t)
+{
+/* return the index of the last page whose first tick is before T
+ * or 0 if there is no such page */
+	size_t lo = 0U, hi = _s->npgd;
+
+	while (lo < hi) {
+		const size_t mid = (lo + hi) / 2U;
+
+		if (_s->pgd[mid].from < t) {
+			lo = mid + 1U;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo ? lo - 1U : 0U;
+}
+
+static ssize_t
+_find_pgo(const struct _ss_s *_s, off_t o)
+{
+/* return the index of the page starting at offset O or -1 */
+	size_t lo = 0U, hi = _s->npgd;
+
+	while (lo < hi) {
+		const size_t mid = (lo + hi) / 2U;
+
+		if (_s->pgd[mid].beg < o) {
+			lo = mid + 1U;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo < _s->npgd && _s->pgd[lo].beg == o ? (ssize_t)lo : -1;
+}
+
+static int
+_rd_idx(struct _ss_s *_s)
+{
+/* read all index entries of _S into its page directory */
+	struct _ss_s *_sidx = (void*)_s->idx;
+	const size_t inflds = _sidx->public.nfields;
+	const char *ilayo = _sidx->public.layout;
+	/* nobody else reads the index, so RO is its first page */
+	const off_t ro = _sidx->ro;
+	const size_t rt = _sidx->rt;
+	const size_t zz = _zone_z(_s->public.layout, _s->public.nfields);
+	uint8_t zon[zz + !zz];
+	int zoned;
+	ssize_t n;
+
+	if (UNLIKELY(inflds < 2U)) {
+		/* not an index of ours */
+		return -1;
+	}
+
+	struct {
+		struct cots_tsoa_s proto;
+		uint64_t *beg;
+		uint64_t *cnt;
+		void *zon[inflds - 2U + 1U];
+	} ix;
+
+	if (UNLIKELY(cots_init_tsoa(&ix.proto, _s->idx) < 0)) {
+		return -1;
+	}
+	/* only use zone maps if they're for our layout */
+	with (char lo[2U * strlen(_s->public.layout) + 3U]) {
+		cots_idx_layo(lo, _s->public.layout);
+		zoned = zz && !strcmp(lo, ilayo);
+	}
+	while ((n = cots_read_ticks(&ix.proto, _s->idx)) > 0) {
+		for (ssize_t i = 0; i < n; i++) {
+			/* entries are relative to the series */
+			const off_t beg = _s->bo + ix.beg[i];
+
+			if (_s->npgd) {
+				/* previous page ends where this one begins */
+				_s->pgd[_s->npgd - 1U].end = beg;
+			}
+			/* gather min/max pairs */
+			for (size_t j = 2U, k = 0U; zoned && j < inflds; j++) {
+				const size_t wid = _layo_wid(ilayo[j]);
+				const uint8_t *zp = ix.zon[j - 2U];
+
+				memcpy(zon + k, zp + i * wid, wid);
+				k += wid;
+			}
+			_add_pgd(_s, (struct pgde_s){
+					 .from = ix.proto.toffs[i],
+					 .beg = beg, .end = beg, .nt = ix.cnt[i]},
+				 zoned ? zon : NULL);
+		}
+	}
+	cots_fini_tsoa(&ix.proto, _s->idx);
+	/* rewind index */
+	_sidx->ro = ro;
+	_sidx->rt = rt;
+	return 0;
+}
+
+static int
+_ld_pgd(struct _ss_s *_s)
+{
+/* make sure the page directory covers all pages up to FO,
+ * consult the index first and walk the remaining pages */
+	const size_t nflds = _s->public.nfields;
+	const off_t hz = _s->bo + _hdrz(_s);
+	struct {
+		struct cots_tsoa_s t;
+		void *cols[nflds];
+	} pg;
+	off_t o;
+
+	if (_s->pgd == NULL && _s->idx != NULL && !(_rd_idx(_s) < 0)) {
+		/* the index must start on the first page and be
+		 * strictly increasing within the data region */
+		for (size_t i = 0U; i < _s->npgd; i++) {
+			const off_t prev = i ? _s->pgd[i - 1U].beg : hz - 1;
+
+			if (UNLIKELY(_s->pgd[i].beg <= prev ||
+				     _s->pgd[i].beg >= _s->fo)) {
+				_s->npgd = 0U;
+			}
+		}
+		if (UNLIKELY(_s->npgd && _s->pgd->beg != hz)) {
+			_s->npgd = 0U;
+		}
+		/* the index doesn't know where the last page ends */
+		if (LIKELY(_s->npgd)) {
+			struct pgde_s *e = _s->pgd + _s->npgd - 1U;
+			struct pagf_s f = _next_pg(_s->fd, e->beg);
+
+			e->end = f.end + sizeof(uint64_t);
+			if (UNLIKELY(f.end <= f.beg || e->end > _s->fo)) {
+				_s->npgd = 0U;
+			}
+		}
+	}
+
+	o = _s->npgd ? _s->pgd[_s->npgd - 1U].end : hz;
+	if (LIKELY(o >= _s->fo)) {
+		/* all pages are accounted for */
+		return 0;
+	} else if (UNLIKELY(cots_init_tsoa_proj(&pg.t, (cots_ts_t)_s, 0U) < 0)) {
+		return -1;
+	}
+	/* we only need time stamps, leave other columns undecoded */
+	while (o < _s->fo) {
+		struct pagf_s f = _next_pg(_s->fd, o);
+		ssize_t nt;
+
+		if (UNLIKELY(f.end <= f.beg || f.end > _s->fo)) {
+			break;
+		}
+		nt = _rd_cpag(&pg.t, _s, &o, f.end - f.beg);
+		if (UNLIKELY(nt <= 0)) {
+			break;
+		}
+		_add_pgd(_s, (struct pgde_s){
+				 .from = *pg.t.toffs,
+				 .beg = f.beg, .end = o, .nt = nt},
+			 NULL);
+	}
+	cots_fini_tsoa(&pg.t, (cots_ts_t)_s);
+	return (o >= _s->fo) - 1;
+}
+
+/* io_uring reads, slots hold the pages of page directory entries
+ * HEAD till TAIL, entry I in slot I % NSL */
+#define UR_PEND		(-2)
+
+struct ur_s {
+	uring_t r;
+	size_t nsl;
+	size_t bufz;
+	/* next page to hand out and next page to submit */
+	size_t head;
+	size_t tail;
+	/* read results of slots, UR_PEND while in flight */
+	ssize_t res[];
+};
+
+static int
+_ur_land(struct ur_s *ur, size_t sl)
+{
+/* wait for the read of slot SL to complete */
+	while (ur->res[sl] == UR_PEND) {
+		size_t i = ur->nsl;
+		ssize_t res = uring_wait(ur->r, &i);
+
+		if (UNLIKELY(i >= ur->nsl)) {
+			/* ring's broken */
+			return -1;
+		}
+		ur->res[i] = res;
+	}
+	return 0;
+}
+
+static void
+_ur_stop(struct _ss_s *_s)
+{
+	if (_s->ur == NULL) {
+		return;
+	}
+	free_uring(_s->ur->r);
+	free(_s->ur);
+	_s->ur = NULL;
+	return;
+}
+
+static ssize_t
+_ur_read(struct cots_tsoa_s *restrict tgt, struct _ss_s *_s)
+{
+/* hand out the page at _S->RO from the ring, keep up to NSL reads in
+ * flight, return -1 to have the caller read the page itself */
+	struct ur_s *ur = _s->ur;
+	const ssize_t k = _find_pgo(_s, _s->ro);
+	const uint8_t *p;
+	struct pgde_s e;
+	size_t sl;
+	size_t nt;
+	size_t t0;
+
+	if (UNLIKELY(k < 0)) {
+		return -1;
+	} else if ((size_t)k != ur->head || ur->head >= ur->tail) {
+		/* caller went elsewhere, let reads in flight land first */
+		for (size_t i = ur->head; i < ur->tail; i++) {
+			if (UNLIKELY(_ur_land(ur, i % ur->nsl) < 0)) {
+				return -1;
+			}
+		}
+		ur->head = ur->tail = k;
+	}
+	/* keep the ring busy, top it up once half of it has been handed
+	 * out so that reads go to the kernel in batches */
+	t0 = ur->tail;
+	while (ur->tail < _s->npgd && ur->tail - ur->head < ur->nsl &&
+	       t0 - ur->head <= ur->nsl / 2U) {
+		const size_t i = ur->tail % ur->nsl;
+
+		e = _s->pgd[ur->tail];
+		if ((size_t)(e.end - e.beg) > ur->bufz || e.end > _s->fo) {
+			/* page won't fit or isn't ours */
+			break;
+		} else if (UNLIKELY(uring_read(ur->r, i, e.beg,
+					       e.end - e.beg) < 0)) {
+			break;
+		}
+		ur->res[i] = UR_PEND;
+		ur->tail++;
+	}
+	if (ur->tail > t0) {
+		const ssize_t n = uring_submit(ur->r);
+
+		/* reads that didn't make it are no longer pending */
+		ur->tail = t0 + (n > 0 ? n : 0);
+	}
+	if (UNLIKELY(ur->head >= ur->tail)) {
+		return -1;
+	} else if (UNLIKELY(_ur_land(ur, sl = ur->head % ur->nsl) < 0)) {
+		return -1;
+	}
+	e = _s->pgd[ur->head++];
+	if (UNLIKELY(ur->res[sl] != e.end - e.beg)) {
+		/* short read */
+		return -1;
+	}
+	p = uring_buf(ur->r, sl);
+	with (uint64_t zn) {
+		size_t nrows;
+		size_t rz;
+
+		memcpy(&zn, p, sizeof(zn));
+		zn = be64toh(zn);
+		nrows = (zn & 0xffffffU) + 1U;
+		rz = zn >> 24U;
+		if (UNLIKELY(sizeof(zn) + rz > (size_t)(e.end - e.beg))) {
+			return -1;
+		}
+		nt = _dcmp_pag(tgt, _s, p + sizeof(zn), rz, nrows, _s->rt);
+	}
+	if (UNLIKELY(!nt)) {
+		return -1;
+	}
+	_s->ro = e.end;
+	_s->rt = 0U;
+	return nt;
+}
+
 static int
 _yank_wal(struct _ss_s *_s, off_t eo)
 {
@@ -1010,6 +2698,8 @@ _yank_wal(struct _ss_s *_s, off_t eo)
 	const size_t nflds = _s->public.nfields;
 	const size_t blkz = _s->public.blockz;
 	const size_t zrow = _layo_zrow(layo, nflds);
+	/* where pages end as far as the file knows */
+	const off_t mo = _s->fo;
 	struct cots_wal_s *res;
 	struct pagf_s f;
 	size_t nt;
@@ -1058,7 +2748,7 @@ _yank_wal(struct _ss_s *_s, off_t eo)
 		/* imprint standard layout on COLS tsoa using mwal's buffer */
 		_layo_impr(&tgt.t, _s->mwal->data, layo, nflds, blkz);
 
-		ntrd = _rd_cpag(&tgt.t, _s->fd, &o, f.end - f.beg, layo, nflds);
+		ntrd = _rd_cpag(&tgt.t, _s, &o, f.end - f.beg);
 		if (UNLIKELY(ntrd < 0)) {
 			goto wal_mwal_out;
 		} else if (UNLIKELY(ntrd != nt)) {
@@ -1076,8 +2766,12 @@ _yank_wal(struct _ss_s *_s, off_t eo)
 		_bang_tsoa(res->data, &tgt.t, nt, layo, nflds);
 		/* increment to WAL to NT */
 		_wal_rset(res, nt);
+		/* ... which are in the file */
+		_wal_stamp(res, mo, nt);
+	} else {
+		/* otherwise don't read anything back, go with a clean WAL */
+		_wal_stamp(res, mo, 0U);
 	}
-	/* otherwise don't read anything back, go with a clean WAL */
 	_s->wal = res;
 	return 0;
 
@@ -1095,7 +2789,7 @@ _move_idx(struct _ss_s *_s, off_t eo)
 	/* estimate how many index sections there will be,
 	 * we'd say there's at most 1kB of index for 10kB of data,
 	 * so simply guesstimate the number as log10 of size minus 3 */
-	const size_t idepth = max_z(log10((double)eo) - 3, 0U);
+	const size_t idepth = eo > 1000 ? (size_t)(log10((double)eo) - 3) : 0U;
 	/* reserve string space */
 	char ifn[flen + strlenof(".idx") * idepth + 1U];
 	struct orng_s irng = {.end = eo};
@@ -1122,35 +2816,280 @@ _move_idx(struct _ss_s *_s, off_t eo)
 		_inject_fn(_s->idx, ifn);
 
 		with (struct _ss_s *_sidx = (void*)_s->idx) {
-			size_t ni;
-
 			/* reprotect the index's header */
 			(void)mprot_any(_sidx->mdr, 0, _hdrz(_sidx), PROT_MEM);
 
 			/* also yank last bob into WAL */
 			if (_yank_wal(_sidx, irng.end - irng.beg) < 0) {
 				break;
-			} else if (!(ni = _wal_rowi(_sidx->wal))) {
+			} else if (!_wal_rowi(_sidx->wal)) {
 				break;
 			}
-			/* and wind back the counter */
-			_wal_rset(_sidx->wal, --ni);
 		}
 	}
 	return 0;
 }
 
-
-/* public series storage API */
-cots_ts_t
-make_cots_ts(const char *layout, size_t blockz)
+static void
+_drop_idx(struct _ss_s *_s)
 {
-	struct _ss_s *res;
-	size_t laylen;
-	size_t zrow;
-
-	if (UNLIKELY((res = calloc(1U, sizeof(*res))) == NULL)) {
-		/* nothing we can do, is there */
+/* series whose last page went back into the WAL will rewrite that page,
+ * so their index must forget about it, do this recursively */
+	for (struct _ss_s *_sidx; (_sidx = (void*)_s->idx); _s = _sidx) {
+		size_t ni;
+
+		if (_s->wal == NULL || !_wal_rowi(_s->wal)) {
+			/* last page stays as is */
+			continue;
+		} else if (_sidx->wal == NULL || !(ni = _wal_rowi(_sidx->wal))) {
+			continue;
+		}
+		/* wind back both counters, the column-WAL would
+		 * otherwise resurrect the entry upon flush */
+		_wal_rset(_sidx->wal, --ni);
+		_wal_rset(_sidx->mwal, ni);
+	}
+	return;
+}
+
+static void
+_open_rw(struct _ss_s *_s, off_t eo, int flags)
+{
+/* prepare series in a file opened for writing, whose series end at EO */
+	/* pass on the right flags */
+	_s->fl = flags;
+	/* read indices and move them */
+	_move_idx(_s, eo);
+	/* turn contents of last page into WAL */
+	_yank_wal(_s, eo);
+	/* and make sure indices don't point to yanked pages */
+	_drop_idx(_s);
+	/* switch off header write protection */
+	(void)mprot_any(_s->mdr, 0, _hdrz(_s), PROT_MEM);
+	return;
+}
+
+static int
+_replay_wal(struct _ss_s *_s, struct cots_wal_s *old, off_t mo)
+{
+/* append the ticks in OLD, the WAL left behind by a writer that never
+ * detached, unless they made it to the file already, that is unless
+ * the file's pages no longer end at MO, where they ended when opened,
+ * OLD is freed, return the number of ticks replayed or -1 */
+	const size_t zrow = old->zrow;
+	const size_t blkz = old->blkz;
+	const size_t nk = old->nkeep;
+	const size_t nt = _wal_rowi(old) - nk;
+	int rc = 0;
+
+	if (old->moff != (uint64_t)mo || nt == 0U) {
+		goto fre_out;
+	} else if (_s->wal == NULL) {
+		/* there was no last page to yank */
+		if (nk) {
+			goto fre_out;
+		}
+		_s->wal = _wal_create(zrow, blkz, _s->public.filename);
+		if (UNLIKELY(_s->wal == NULL)) {
+			rc = -1;
+			goto fre_out;
+		} else if (UNLIKELY((_s->mwal = _make_wal(zrow, blkz)) == NULL)) {
+			_free_wal(_s->wal);
+			_s->wal = NULL;
+			rc = -1;
+			goto fre_out;
+		}
+		_wal_stamp(_s->wal, mo, 0U);
+	} else if (_wal_rowi(_s->wal) != nk) {
+		/* the last page isn't what OLD thinks it is */
+		goto fre_out;
+	}
+	/* the file's WAL is the only copy now */
+	rc = cots_write_ticks(
+		(cots_ts_t)_s, (const void*)(old->data + nk * zrow), nt);
+	rc = rc ?: msync_any(_s->wal, 0,
+			     sizeof(*_s->wal) + _wal_rowi(_s->wal) * zrow,
+			     MS_SYNC);
+	rc = rc ?: (int)nt;
+fre_out:
+	_free_wal(old);
+	return rc;
+}
+
+static off_t
+_rlp_off(const struct _ss_s *_s, off_t eo)
+{
+/* rollups go last, so the index chain ends where the first one starts */
+	for (size_t k = 0U; k < _s->nrlp; k++) {
+		const struct orng_s r = _s->rlp[k].r;
+
+		if (r.beg < r.end && r.beg < eo) {
+			eo = r.beg;
+		}
+	}
+	return eo;
+}
+
+static cots_ts_t
+_rlp_make(const struct _ss_s *_s, size_t k)
+{
+/* create the companion series of the K-th rollup in a temp file */
+	static const char *flds[] = {"open", "high", "low", "close", "volume"};
+	const char *fn = _s->public.filename;
+	const int fl = O_CREAT | O_TRUNC/*?*/ | O_RDWR;
+	char rfn[strlen(fn) + strlenof(".rlp") + 21U];
+	cots_ts_t res;
+
+	snprintf(rfn, sizeof(rfn), "%s.rlp%zu", fn, k);
+	res = make_cots_ts(rlp_layout, _s->public.blockz);
+	if (UNLIKELY(res == NULL)) {
+		return NULL;
+	} else if (UNLIKELY(cots_attach(res, rfn, fl) < 0)) {
+		free_cots_ts(res);
+		return NULL;
+	}
+	(void)cots_put_fields(res, flds);
+	return res;
+}
+
+static void
+_free_rlp(struct _ss_s *_s)
+{
+	for (size_t k = 0U; k < _s->nrlp; k++) {
+		if (_s->rlp[k].ts == NULL) {
+			continue;
+		} else if (_s->fl != O_RDONLY) {
+			/* temp files, rid the file system of them */
+			free_cots_idx(_s->rlp[k].ts);
+		} else {
+			free_cots_ts(_s->rlp[k].ts);
+		}
+	}
+	free(_s->rlp);
+	_s->rlp = NULL;
+	_s->nrlp = 0U;
+	return;
+}
+
+static size_t
+_yank_full(struct _ss_s *_s)
+{
+/* like _yank_wal() but for a full last page, put its ticks back into
+ * the (empty) WAL and count all but the last one, so that the last
+ * one can be taken back as well, return the number of ticks or 0 */
+	const char *layo = _s->public.layout;
+	const size_t nflds = _s->public.nfields;
+	const size_t blkz = _s->public.blockz;
+	struct {
+		union {
+			struct cots_tsoa_s t;
+			void *toffs;
+		};
+		void *flds[nflds];
+	} tgt;
+	struct pagf_s f;
+	off_t o;
+	size_t ni;
+
+	f = _prev_pg(_s->fd, _s->fo);
+	if (UNLIKELY(_s->mwal == NULL || f.beg >= f.end)) {
+		return 0U;
+	} else if (UNLIKELY(f.beg < _s->bo + (off_t)_hdrz(_s))) {
+		/* that's the header */
+		return 0U;
+	}
+	_layo_impr(&tgt.t, _s->mwal->data, layo, nflds, blkz);
+	o = f.beg;
+	with (ssize_t nt = _rd_cpag(&tgt.t, _s, &o, f.end - f.beg)) {
+		if (UNLIKELY(nt != (ssize_t)blkz)) {
+			return 0U;
+		}
+	}
+	/* the page will be rewritten */
+	_s->fo = f.beg;
+	_bang_tsoa(_s->wal->data, &tgt.t, blkz, layo, nflds);
+	_wal_rset(_s->wal, blkz - 1U);
+	_wal_rset(_s->mwal, blkz - 1U);
+	/* and its index entry must go */
+	with (struct _ss_s *_sidx = (void*)_s->idx) {
+		if (_sidx == NULL || _sidx->wal == NULL ||
+		    !(ni = _wal_rowi(_sidx->wal))) {
+			break;
+		}
+		_wal_rset(_sidx->wal, --ni);
+		_wal_rset(_sidx->mwal, ni);
+	}
+	return blkz;
+}
+
+static int
+_move_rlp(struct _ss_s *_s)
+{
+/* cut rollups out of the file into temp files and pick up their
+ * last bars again, as ticks in their interval might follow */
+	const char *fn = _s->public.filename;
+	char rfn[strlen(fn) + strlenof(".rlp") + 21U];
+
+	for (size_t k = 0U; k < _s->nrlp; k++) {
+		struct rlp_s *r = _s->rlp + k;
+		const off_t rz = r->r.end - r->r.beg;
+		struct _ss_s *_r;
+		size_t ni;
+		int rfd;
+
+		snprintf(rfn, sizeof(rfn), "%s.rlp%zu", fn, k);
+		if ((rfd = _yank_rng(rfn, _s->fd, r->r)) < 0) {
+			goto fre_out;
+		}
+		r->ts = _open_core(rfd, (struct orng_s){0, rz});
+		if (UNLIKELY(r->ts == NULL)) {
+			close(rfd);
+			(void)unlink(rfn);
+			goto fre_out;
+		}
+		_inject_fn(r->ts, rfn);
+		_open_rw(_r = (void*)r->ts, rz, _s->fl);
+		/* the directory entry is stale from now on */
+		r->r = (struct orng_s){0, 0};
+
+		if (_r->wal == NULL) {
+			continue;
+		} else if (!(ni = _wal_rowi(_r->wal)) &&
+			   !(ni = _yank_full(_r))) {
+			/* last bar went out on a page we can't read back */
+			continue;
+		}
+		/* take the last bar back from the WAL */
+		with (struct rlpt_s t) {
+			memcpy(&t, _r->wal->data + (ni - 1U) * _r->wal->zrow,
+			       sizeof(t));
+			r->b = (struct bar_s){
+				t.proto.toff, 1U,
+				memcmp(&t.o, &COTS_PX_MISS, sizeof(t.o)) != 0,
+				t.o, t.h, t.l, t.c, t.v
+			};
+		}
+		_wal_rset(_r->wal, --ni);
+		_wal_rset(_r->mwal, ni);
+	}
+	return 0;
+
+fre_out:
+	_free_rlp(_s);
+	return -1;
+}
+
+
+/* public series storage API */
+cots_ts_t
+make_cots_ts(const char *layout, size_t blockz)
+{
+	struct _ss_s *res;
+	size_t laylen;
+	size_t zrow;
+
+	if (UNLIKELY((res = calloc(1U, sizeof(*res))) == NULL)) {
+		/* nothing we can do, is there */
 		return NULL;
 	}
 
@@ -1181,6 +3120,7 @@ make_cots_ts(const char *layout, size_t blockz)
 
 	/* use a backing file? */
 	res->fd = -1;
+	res->dfd = -1;
 
 	/* create an obarray if there's strings */
 	if (strchr(res->public.layout, COTS_LO_STR)) {
@@ -1211,6 +3151,7 @@ free_cots_ts(cots_ts_t s)
 	if (_s->ob != NULL) {
 		free_cots_ob(_s->ob);
 	}
+	free(_s->st);
 	free(_s);
 	return;
 }
@@ -1218,11 +3159,14 @@ free_cots_ts(cots_ts_t s)
 cots_ts_t
 cots_open_ts(const char *file, int flags)
 {
+	/* direct reads are for read-only series */
+	const int dio = flags & O_DIRECT;
 	struct stat st;
 	cots_ts_t res;
 	off_t eo;
 	int fd;
 
+	flags &= ~O_DIRECT;
 	if ((fd = open(file, flags ? O_RDWR : O_RDONLY)) < 0) {
 		return NULL;
 	} else if (UNLIKELY(fstat(fd, &st) < 0)) {
@@ -1241,20 +3185,31 @@ cots_open_ts(const char *file, int flags)
 		/* do up the index, coupling! */
 		struct _ss_s *_res = (void*)res;
 
-		_open_idx(_res, eo);
+		_open_idx(_res, (struct orng_s){0, _rlp_off(_res, eo)});
+		/* pages bypass the page cache, everything else doesn't */
+		if (dio && (_res->dfd = open(file, O_RDONLY | O_DIRECT)) >= 0) {
+			_rd_init(&_res->rw, _res);
+		}
 	} else {
 		/* right, dissect file, put index into separate file
-		 * and do that recursively */
+		 * and do that recursively, same for rollups */
 		struct _ss_s *_res = (void*)res;
+		const off_t io = _rlp_off(_res, eo);
+		const off_t mo = _res->fo;
+		/* a WAL that's still around is from a crashed writer */
+		struct cots_wal_s *old = _wal_snarf(
+			_layo_zrow(res->layout, res->nfields),
+			res->blockz, file);
 
-		/* pass on the right flags */
 		_res->fl = flags;
-		/* read indices and move them */
-		_move_idx(_res, eo);
-		/* turn contents of last page into WAL */
-		_yank_wal(_res, eo);
-		/* switch off header write protection */
-		(void)mprot_any(_res->mdr, 0, _hdrz(_res), PROT_MEM);
+		_move_rlp(_res);
+		_open_rw(_res, io, flags);
+		/* ticks put back into the WAL are in the rollups already */
+		_res->rlpt = _res->wal != NULL ? _wal_rowi(_res->wal) : 0U;
+		/* ticks left in the old WAL aren't */
+		if (old != NULL) {
+			(void)_replay_wal(_res, old, mo);
+		}
 	}
 	return res;
 
@@ -1288,6 +3243,7 @@ cots_attach(cots_ts_t s, const char *file, int flags)
  * 7.      x            x             -
  * 8.      x            x             x
  */
+	struct cots_wal_s *old = NULL;
 	struct fhdr_s *mdr;
 	struct stat st;
 	int fd;
@@ -1316,7 +3272,11 @@ cots_attach(cots_ts_t s, const char *file, int flags)
 			unsigned int lgbz = log_blkz(s->blockz);
 
 			/* keep track of block size */
-			proto.flags = htobe64(lgbz & 0xfU);
+			uint64_t fl = lgbz & 0xfU;
+
+			/* and of block directories */
+			fl |= ((struct _ss_s*)s)->bdir ? FHDR_BDIR : 0U;
+			proto.flags = htobe64(fl);
 
 			memcpy(mdr, &proto, sizeof(*mdr));
 			memcpy(mdr->layout, s->layout, s->nfields + 1U);
@@ -1343,6 +3303,9 @@ cots_attach(cots_ts_t s, const char *file, int flags)
 		}
 		/* yep they do, switch off write protection */
 		(void)mprot_any(mdr, 0, hz, PROT_MEM);
+		/* a WAL that's still around is from a crashed writer */
+		old = _wal_snarf(_layo_zrow(s->layout, s->nfields),
+				 s->blockz, file);
 	}
 
 	/* we're good to go, detach any old files */
@@ -1355,15 +3318,29 @@ cots_attach(cots_ts_t s, const char *file, int flags)
 		_s->public.filename = strdup(file);
 		_s->fd = fd;
 		_s->fl = flags;
+		_s->dev = st.st_dev;
+		_s->ino = st.st_ino;
 		/* store current index offs or file size as blob offs */
 		_s->fo = be64toh(mdr->moff) ?: st.st_size;
 		_s->ro = _hdrz(_s);
+		/* stick with the file's choice of block directories */
+		_s->bdir = !!(be64toh(mdr->flags) & FHDR_BDIR);
 
 		/* (re)attach the wal */
 		_s->mwal = _s->wal;
 		_s->wal = _wal_attach(_s->mwal, file);
 		/* consider mwal flushed */
 		_wal_rset(_s->mwal, 0U);
+
+		if (_s->wal != NULL) {
+			_wal_stamp(_s->wal, _s->fo, 0U);
+		}
+		/* replay the crashed writer's ticks, if they fit */
+		if (old != NULL && _s->wal != NULL) {
+			(void)_replay_wal(_s, old, _s->fo);
+		} else if (old != NULL) {
+			_free_wal(old);
+		}
 	}
 	return 0;
 
@@ -1384,6 +3361,7 @@ cots_detach(cots_ts_t s)
 	struct _ss_s *_s = (void*)s;
 
 	cots_freeze(s);
+	_cw_stop(_s);
 
 	if (_s->wal && _wal_detach(_s->wal, _s->public.filename) < 0) {
 		/* great, just keep using the wal */
@@ -1396,6 +3374,29 @@ cots_detach(cots_ts_t s)
 		/* assume flushed wal */
 		_wal_rset(_s->wal, 0U);
 	}
+	if (_s->pgd) {
+		free(_s->pgd);
+		_s->pgd = NULL;
+		free(_s->zon);
+		_s->zon = NULL;
+		_s->npgd = _s->zpgd = 0U;
+	}
+	if (_s->apg) {
+		cots_fini_tsoa(_s->apg, s);
+		free(_s->apg);
+		_s->apg = NULL;
+		_s->apo = 0;
+	}
+	if (_s->rs) {
+		cots_fini_tsoa(_s->rs->pg, s);
+		free(_s->rs->pg);
+		free(_s->rs);
+		_s->rs = NULL;
+	}
+	if (_s->rlp) {
+		/* same for rollups */
+		_free_rlp(_s);
+	}
 	if (_s->idx) {
 		/* assume index has been dealt with in _freeze() */
 		if (_s->fl != O_RDONLY) {
@@ -1413,6 +3414,15 @@ cots_detach(cots_ts_t s)
 		munmap_any(_s->mdr, 0, _hdrz(_s));
 		_s->mdr = NULL;
 	}
+	_pf_stop(_s);
+	_ur_stop(_s);
+	_rd_unmap(&_s->rw);
+	_flw_unwal(_s);
+	_s->flw = 0;
+	if (_s->dfd >= 0) {
+		close(_s->dfd);
+		_s->dfd = -1;
+	}
 	if (_s->fd >= 0) {
 		close(_s->fd);
 		_s->fd = -1;
@@ -1427,6 +3437,8 @@ int
 cots_freeze(cots_ts_t s)
 {
 	struct _ss_s *_s = (void*)s;
+	/* rollups of read-only series are in the file already */
+	const size_t nrlp = _s->fl != O_RDONLY ? _s->nrlp : 0U;
 	int rc;
 
 	if (UNLIKELY(_s->fd < 0)) {
@@ -1437,203 +3449,1636 @@ cots_freeze(cots_ts_t s)
 	/* flush wal to file */
 	rc = _flush(_s);
 
+	/* bars under construction are as complete as they get */
+	for (size_t k = 0U; k < nrlp; k++) {
+		if (_s->rlp[k].b.nb) {
+			_rlp_emit(_s->rlp + k);
+		}
+		cots_freeze(_s->rlp[k].ts);
+	}
 	if (_s->idx) {
 		/* this is bad coupling:
 		 * we know _s->idx is in fact a normal _ss_s object
 		 * just freeze things here,
 		 * then use its fd and sendfile(3) to append index */
 		cots_freeze(_s->idx);
+	}
+	if (nrlp) {
+		/* rollups go behind the index, record where in the meta
+		 * section, chunk sizes don't depend on the offsets so
+		 * the index goes where the meta section ends */
+		struct stat st;
+		off_t o;
+
+		_s->rlp->r.end = 1;
+		o = _s->fo + _meta_z(_s);
+		if (_s->idx && fstat(((struct _ss_s*)_s->idx)->fd, &st) == 0) {
+			o += st.st_size;
+		}
+		for (size_t k = 0U; k < nrlp; k++) {
+			const struct _ss_s *_r = (const void*)_s->rlp[k].ts;
+
+			if (UNLIKELY(fstat(_r->fd, &st) < 0)) {
+				st.st_size = 0;
+			}
+			_s->rlp[k].r = (struct orng_s){o, o + st.st_size};
+			o += st.st_size;
+		}
+		_updt_hdr(_s, _wr_meta(_s));
+	}
+	if (_s->idx) {
 		_cat(_s, _s->idx);
 	}
+	if (nrlp) {
+		for (size_t k = 0U; k < nrlp; k++) {
+			_cat(_s, _s->rlp[k].ts);
+			_s->rlp[k].r = (struct orng_s){0, 0};
+		}
+		/* left-overs from an earlier freeze are of no use */
+		(void)ftruncate(_s->fd, lseek(_s->fd, 0, SEEK_CUR));
+	}
+	return rc;
+}
+
+
+int
+cots_bang_tick(cots_ts_t s, const struct cots_tick_s *data)
+{
+	struct _ss_s *_s = (void*)s;
+
+	if (UNLIKELY(data->toff < _last_toff(_s))) {
+		/* can't go back in time */
+		return -1;
+	}
+	/* otherwise bang, this is a wal routine */
+	_wal_bang(_s->wal, data);
+	return 0;
+}
+
+static int
+_evict(struct _ss_s *_s)
+{
+/* flush the full WAL, one way or another */
+	/* just for now */
+	if (!_s->idx) {
+		_s->idx = make_cots_idx(_s->public.filename, _s->public.layout);
+	}
+	/* auto-eviction */
+	return !_s->cw ? _flush(_s) : _cw_hand(_s);
+}
+
+int
+cots_keep_last(cots_ts_t s)
+{
+	struct _ss_s *_s = (void*)s;
+	const size_t blkz = _s->public.blockz;
+	int rc = 0;
+	size_t n;
+
+	n = _wal_rinc(_s->wal);
+	if (UNLIKELY(_s->dur.how & COTS_SYNC_WAL)) {
+		rc = _dur_wal(_s, 1U);
+	}
+	if (UNLIKELY(n == blkz)) {
+		rc = _evict(_s) ?: rc;
+	}
+	return rc;
+}
+
+int
+cots_durability(cots_ts_t s, unsigned int how, size_t nticks, uint64_t usec)
+{
+	struct _ss_s *_s = (void*)s;
+	const unsigned int all = COTS_SYNC_WAL | COTS_SYNC_PAGE | COTS_SYNC_GROUP;
+
+	if (UNLIKELY(how & ~all)) {
+		/* don't know what they want */
+		return -1;
+	}
+	_s->dur = (struct dur_s){
+		.how = how, .n = nticks, .usec = usec,
+		.last = usec ? _now_ns() : 0U,
+	};
+	return 0;
+}
+
+int
+cots_async_flush(cots_ts_t s, int on)
+{
+	struct _ss_s *_s = (void*)s;
+	struct cw_s *cw;
+
+	if (!on) {
+		return _cw_stop(_s);
+	} else if (_s->cw) {
+		/* already on */
+		return 0;
+	} else if (UNLIKELY(_s->fd < 0 || _s->fl == O_RDONLY)) {
+		/* nowhere to flush to */
+		return -1;
+	} else if (UNLIKELY((cw = calloc(1, sizeof(*cw))) == NULL)) {
+		return -1;
+	}
+	cw->w = _make_wal(_s->wal->zrow, _s->wal->blkz);
+	cw->m = _make_wal(_s->wal->zrow, _s->wal->blkz);
+	if (UNLIKELY(cw->w == NULL || cw->m == NULL)) {
+		goto nomem;
+	}
+	pthread_mutex_init(&cw->mtx, NULL);
+	pthread_cond_init(&cw->cnd, NULL);
+	_s->cw = cw;
+	if (UNLIKELY(pthread_create(&cw->th, NULL, _cw_work, _s))) {
+		pthread_cond_destroy(&cw->cnd);
+		pthread_mutex_destroy(&cw->mtx);
+		_s->cw = NULL;
+		goto nomem;
+	}
+	return 0;
+
+nomem:
+	_cw_free(cw);
+	return -1;
+}
+
+int
+cots_block_dirs(cots_ts_t s, int on)
+{
+	struct _ss_s *_s = (void*)s;
+	const uint64_t bdir = htobe64(FHDR_BDIR);
+
+	if (UNLIKELY(_s->fd >= 0 && _s->fl == O_RDONLY)) {
+		/* pages are written already */
+		return -1;
+	} else if (_s->cw != NULL) {
+		/* not while the worker compacts a page */
+		pthread_mutex_lock(&_s->cw->mtx);
+		while (_s->cw->busy) {
+			pthread_cond_wait(&_s->cw->cnd, &_s->cw->mtx);
+		}
+	}
+	_s->bdir = !!on;
+	if (_s->mdr == NULL) {
+		/* will go into the header upon attaching */
+		;
+	} else if (on) {
+		__atomic_fetch_or(&_s->mdr->flags, bdir, __ATOMIC_RELAXED);
+	} else {
+		__atomic_fetch_and(&_s->mdr->flags, ~bdir, __ATOMIC_RELAXED);
+	}
+	if (_s->cw != NULL) {
+		pthread_mutex_unlock(&_s->cw->mtx);
+	}
+	return 0;
+}
+
+
+int
+cots_write_tick(cots_ts_t s, const struct cots_tick_s *data)
+{
+	return !(cots_bang_tick(s, data) < 0)
+		? cots_keep_last(s)
+		: -1;
+}
+
+int
+cots_write_ticks(cots_ts_t s, const struct cots_tick_s *data, size_t n)
+{
+	struct _ss_s *_s = (void*)s;
+	const size_t blkz = _s->public.blockz;
+	const size_t zrow = _s->wal->zrow;
+	const uint8_t *rp = (const uint8_t*)data;
+	cots_to_t last = _last_toff(_s);
+	int rc = 0;
+
+	/* check the batch as a whole, don't write half of it */
+	for (size_t i = 0U; i < n; i++) {
+		const struct cots_tick_s *t = (const void*)(rp + i * zrow);
+
+		if (UNLIKELY(t->toff < last)) {
+			/* can't go back in time */
+			return -1;
+		}
+		last = t->toff;
+	}
+	/* copy runs up to the end of the WAL */
+	for (size_t i = 0U, m; i < n; i += m) {
+		const size_t rowi = _wal_rowi(_s->wal);
+
+		m = min_z(blkz - rowi, n - i);
+		memcpy(_s->wal->data + rowi * zrow, rp + i * zrow, m * zrow);
+		if (UNLIKELY(_wal_radd(_s->wal, m) == blkz)) {
+			rc = _evict(_s) ?: rc;
+		} else if (UNLIKELY(_s->dur.how & COTS_SYNC_WAL)) {
+			rc = _dur_wal(_s, m) ?: rc;
+		}
+	}
+	return rc;
+}
+
+int
+cots_write_tsoa(cots_ts_t s, const struct cots_tsoa_s *src, size_t n)
+{
+	struct _ss_s *_s = (void*)s;
+	const size_t blkz = _s->public.blockz;
+	const size_t nflds = _s->public.nfields;
+	const char *layo = _s->public.layout;
+	struct cots_wal_s *w = _s->wal;
+	struct {
+		struct cots_tsoa_s proto;
+		void *cols[nflds];
+	} v, m;
+	int rc = 0;
+
+	if (UNLIKELY(!n)) {
+		return 0;
+	} else if (UNLIKELY(src->toffs[0U] < _last_toff(_s))) {
+		/* can't go back in time */
+		return -1;
+	}
+	for (size_t i = 1U; i < n; i++) {
+		if (UNLIKELY(src->toffs[i] < src->toffs[i - 1U])) {
+			return -1;
+		}
+	}
+	for (size_t i = 0U; i < nflds; i++) {
+		if (UNLIKELY(src->cols[i] == NULL)) {
+			/* projected tsoas won't do */
+			return -1;
+		}
+	}
+	for (size_t i = 0U, k; i < n; i += k) {
+		const size_t rowi = _wal_rowi(w);
+
+		/* view on SRC as of tick I */
+		v.proto.toffs = src->toffs + i;
+		for (size_t j = 0U; j < nflds; j++) {
+			const size_t wid = _layo_wid(layo[j]);
+			v.cols[j] = (uint8_t*)src->cols[j] + i * wid;
+		}
+
+		if (!rowi && n - i >= blkz && _s->fd >= 0 && !_s->cw) {
+			/* whole page, compact straight from SRC */
+			const uint64_t t0 = _s->st ? _now_ns() : 0U;
+			struct blob_s b;
+
+			k = blkz;
+			if (!_s->idx) {
+				const char *fn = _s->public.filename;
+				_s->idx = make_cots_idx(fn, layo);
+			}
+			b = _comp_blob(layo, nflds, &v.proto, k, _s->bdir);
+			if (UNLIKELY(b.data == NULL)) {
+				return -1;
+			}
+			rc = _wr_page(_s, b, &v.proto, k, t0) ?: rc;
+			_free_blob(b);
+			_wal_stamp(w, _s->fo, 0U);
+			/* the last tick goes where _last_toff() finds it */
+			_row_tick(w->data + (blkz - 1U) * w->zrow,
+				  &v.proto, k - 1U, layo, nflds);
+			continue;
+		}
+		/* partial page, WAL gets the rows,
+		 * the columns go to the columnar WAL as-is */
+		k = min_z(blkz - rowi, n - i);
+		_bang_tsoa(w->data + rowi * w->zrow, &v.proto, k, layo, nflds);
+		if (_s->mwal == NULL) {
+			/* unattached series have no columnar WAL */
+			;
+		} else {
+			_wal_cols(&m.proto, _s);
+			memcpy(m.proto.toffs + rowi, v.proto.toffs,
+			       k * sizeof(*v.proto.toffs));
+			for (size_t j = 0U; j < nflds; j++) {
+				const size_t wid = _layo_wid(layo[j]);
+				memcpy((uint8_t*)m.cols[j] + rowi * wid,
+				       v.cols[j], k * wid);
+			}
+			_wal_radd(_s->mwal, k);
+		}
+		if (_wal_radd(w, k) == blkz) {
+			rc = _evict(_s) ?: rc;
+		} else if (UNLIKELY(_s->dur.how & COTS_SYNC_WAL)) {
+			rc = _dur_wal(_s, k) ?: rc;
+		}
+	}
 	return rc;
 }
 
-
 int
-cots_bang_tick(cots_ts_t s, const struct cots_tick_s *data)
+cots_write_va(cots_ts_t s, cots_to_t t, ...)
+{
+	struct _ss_s *_s = (void*)s;
+	const char *flds = _s->public.layout;
+	const size_t nflds = _s->public.nfields;
+	uint8_t rp[_s->wal->zrow] __attribute__((aligned(16)));
+	va_list vap;
+
+	with (cots_to_t *tp = (void*)rp) {
+		*tp = t;
+	}
+	va_start(vap, t);
+	for (size_t i = 0U, a = _layo_zrow(flds, i), wid = 0U; i < nflds; i++) {
+		/* get current field's width and alignment */
+		a += wid, wid = _layo_wid(flds[i]), a = _layo_algn(a, wid);
+
+		switch (wid) {
+		case 1U:
+		case 2U:
+		case 4U: {
+			uint32_t *cp = (uint32_t*)(rp + a);
+			*cp = va_arg(vap, uint32_t);
+			break;
+		}
+
+		case 8U: {
+			uint64_t *cp = (uint64_t*)(rp + a);
+			*cp = va_arg(vap, uint64_t);
+			break;
+		}
+		default:
+			break;
+		}
+	}
+	va_end(vap);
+
+	return cots_write_tick(s, (const void*)rp);
+}
+
+int
+cots_init_tsoa(struct cots_tsoa_s *restrict tgt, cots_ts_t s)
+{
+	return cots_init_tsoa_proj(tgt, s, -1ULL);
+}
+
+int
+cots_init_tsoa_proj(
+	struct cots_tsoa_s *restrict tgt, cots_ts_t s, uint64_t proj)
+{
+	const size_t blkz = s->blockz;
+	const size_t nflds = s->nfields;
+	size_t nproj = 0U;
+	void *rb;
+
+	/* fields beyond the 64th are always projected */
+	for (size_t i = 0U; i < nflds; i++) {
+		nproj += i >= 64U || (proj >> i) & 0b1U;
+	}
+	/* leave room for decoders spilling past the last column */
+	rb = calloc(sizeof(uint64_t), (nproj + 1U) * blkz + DCMP_SPILL);
+	if (UNLIKELY((tgt->toffs = (cots_to_t*)rb) == NULL)) {
+		return -1;
+	}
+	for (size_t i = 0U, j = 1U; i < nflds; i++) {
+		if (i >= 64U || (proj >> i) & 0b1U) {
+			tgt->cols[i] = tgt->toffs + j++ * blkz;
+		} else {
+			/* not projected, won't be decoded */
+			tgt->cols[i] = NULL;
+		}
+	}
+	return 0;
+}
+
+int
+cots_fini_tsoa(struct cots_tsoa_s *restrict tgt, cots_ts_t UNUSED(s))
+{
+	if (UNLIKELY(tgt->toffs == NULL)) {
+		return -1;
+	}
+	free(tgt->toffs);
+	return 0;
+}
+
+ssize_t
+cots_read_ticks(struct cots_tsoa_s *restrict tgt, cots_ts_t s)
+{
+/* currently this is mmap only */
+	struct _ss_s *_s = (void*)s;
+	const size_t nflds = _s->public.nfields;
+	const char *layo = _s->public.layout;
+	size_t nr;
+
+	if (UNLIKELY(_s->fd < 0)) {
+		/* no backing file */
+		return -1;
+	} else if (UNLIKELY(_s->ro >= _s->fo) && _s->mwal) {
+		/* no compressed ticks on their pages, innit? */
+		goto _wal_read_ticks;
+	} else if (UNLIKELY(_s->ro >= _s->fo) && _s->flw) {
+		/* the writer's WAL, unless they flushed meanwhile */
+		ssize_t n = _flw_read(tgt, _s);
+
+		if (n || _s->ro >= _s->fo) {
+			return n;
+		}
+	} else if (UNLIKELY(_s->ro >= _s->fo)) {
+		return 0;
+	}
+
+	if (_s->pf && !_s->rt) {
+		/* try the read-ahead first */
+		ssize_t npf = _pf_read(tgt, _s);
+
+		if (LIKELY(npf > 0)) {
+			return npf;
+		}
+	}
+	if (_s->ur) {
+		/* try the ring, it knows about extra-time */
+		ssize_t nur = _ur_read(tgt, _s);
+
+		if (LIKELY(nur > 0)) {
+			return nur;
+		}
+	}
+	/* read/decomp the page, in extra-time start at row _s->rt */
+	nr = _rd_cpag_r(tgt, _s, &_s->rw, &_s->ro, _s->fo - _s->ro, _s->rt);
+	/* page's consumed, next one starts afresh */
+	_s->rt = 0U;
+	return nr;
+
+_wal_read_ticks:
+	{
+		struct {
+			struct cots_tsoa_s proto;
+			void *cols[nflds];
+		} cols;
+		size_t nt = _wal_cols(&cols.proto, _s);
+
+		if (UNLIKELY(_s->rt >= nt)) {
+			return 0;
+		}
+		/* we'd be writing NT ticks, offset at _S->RT */
+		nt -= _s->rt;
+		/* time vector first */
+		memcpy(tgt->toffs, cols.proto.toffs + _s->rt,
+		       nt * sizeof(*tgt->toffs));
+		for (size_t i = 0U; i < nflds; i++) {
+			const size_t wid = _layo_wid(layo[i]);
+			const uint8_t *sp = cols.proto.cols[i];
+
+			if (tgt->cols[i] == NULL) {
+				/* not projected */
+				continue;
+			}
+			memcpy(tgt->cols[i], sp + _s->rt * wid, nt * wid);
+		}
+		_s->rt += nt;
+		return nt;
+	}
+}
+
+static size_t
+_rd_peek(struct _ss_s *_s)
+{
+/* return an upper bound of the number of ticks the next read yields */
+	if (_s->ro < _s->fo) {
+		const uint8_t *p;
+		uint64_t zn;
+
+		p = _rd_map(&_s->rw, _s->fd, _s->ro, sizeof(zn));
+		if (UNLIKELY(p == NULL)) {
+			return _s->public.blockz;
+		}
+		memcpy(&zn, p, sizeof(zn));
+		zn = be64toh(zn);
+		return (zn & 0xffffffU) + 1U - _s->rt;
+	} else if (_s->mwal) {
+		const size_t nt = _wal_rowi(_s->wal);
+
+		return nt > _s->rt ? nt - _s->rt : 0U;
+	} else if (!_s->flw) {
+		/* nothing to read */
+		return 0U;
+	}
+	return _s->public.blockz;
+}
+
+ssize_t
+cots_read_ticks_n(struct cots_tsoa_s *restrict tgt, cots_ts_t s, size_t n)
+{
+	struct _ss_s *_s = (void*)s;
+	const size_t nflds = _s->public.nfields;
+	const char *layo = _s->public.layout;
+	struct {
+		struct cots_tsoa_s t;
+		void *cols[nflds];
+	} v, b;
+	size_t nr = 0U;
+
+	b.t.toffs = NULL;
+
+	while (nr < n) {
+		const size_t np = _rd_peek(_s);
+		struct cots_tsoa_s *t = &v.t;
+		ssize_t nt;
+
+		if (np > n - nr) {
+			/* page won't fit, leave it for the next call */
+			break;
+		} else if (np + DCMP_SPILL > n - nr) {
+			/* decoders may spill past the page, use bounce buffer */
+			uint64_t proj = 0U;
+
+			for (size_t i = 0U; i < nflds && i < 64U; i++) {
+				proj |= (uint64_t)(tgt->cols[i] != NULL) << i;
+			}
+			if (b.t.toffs == NULL &&
+			    UNLIKELY(cots_init_tsoa_proj(&b.t, s, proj) < 0)) {
+				break;
+			}
+			t = &b.t;
+		} else {
+			/* decode straight into TGT at row NR */
+			v.t.toffs = tgt->toffs + nr;
+			for (size_t i = 0U; i < nflds; i++) {
+				uint8_t *tp = tgt->cols[i];
+				const size_t wid = _layo_wid(layo[i]);
+
+				v.cols[i] = tp ? tp + nr * wid : NULL;
+			}
+		}
+		if ((nt = cots_read_ticks(t, s)) <= 0) {
+			break;
+		} else if (t == &b.t) {
+			memcpy(tgt->toffs + nr, b.t.toffs,
+			       nt * sizeof(*tgt->toffs));
+			for (size_t i = 0U; i < nflds; i++) {
+				const size_t wid = _layo_wid(layo[i]);
+				uint8_t *tp = tgt->cols[i];
+
+				if (tp == NULL) {
+					/* not projected */
+					continue;
+				}
+				memcpy(tp + nr * wid, b.t.cols[i], nt * wid);
+			}
+		}
+		nr += nt;
+	}
+	if (b.t.toffs != NULL) {
+		cots_fini_tsoa(&b.t, s);
+	}
+	/* not even one page fitted? */
+	return nr || !_rd_peek(_s) ? (ssize_t)nr : -1;
+}
+
+ssize_t
+cots_read_ticks_rev(struct cots_tsoa_s *restrict tgt, cots_ts_t s)
+{
+	struct _ss_s *_s = (void*)s;
+	const size_t nflds = _s->public.nfields;
+	const char *layo = _s->public.layout;
+	const off_t hz = _s->bo + _hdrz(_s);
+	ssize_t nr;
+
+	if (UNLIKELY(_s->fd < 0)) {
+		/* no backing file */
+		return -1;
+	}
+	/* any range reads will have to start over */
+	_s->rng = (struct trng_s){0U, 0U};
+
+	if (_s->rt && _s->ro >= _s->fo && _s->mwal) {
+		/* unflushed ticks before the read position */
+		struct {
+			struct cots_tsoa_s proto;
+			void *cols[nflds];
+		} cols;
+
+		nr = min_z(_wal_cols(&cols.proto, _s), _s->rt);
+		memcpy(tgt->toffs, cols.proto.toffs, nr * sizeof(*tgt->toffs));
+		for (size_t i = 0U; i < nflds; i++) {
+			if (tgt->cols[i] == NULL) {
+				/* not projected */
+				continue;
+			}
+			memcpy(tgt->cols[i], cols.proto.cols[i],
+			       nr * _layo_wid(layo[i]));
+		}
+	} else if (_s->rt && _s->ro < _s->fo) {
+		/* ticks before the read position on its page */
+		off_t o = _s->ro;
+
+		nr = _rd_cpag(tgt, _s, &o, _s->fo - o);
+		if (UNLIKELY(nr <= 0)) {
+			return -1;
+		}
+		nr = min_z(nr, _s->rt);
+	} else if (_s->ro > hz) {
+		/* the page before the read position, its trailer says where */
+		const off_t eo = min_z(_s->ro, _s->fo);
+		struct pagf_s f = _prev_pg(_s->fd, eo);
+		off_t o = f.beg;
+
+		if (UNLIKELY(f.end <= f.beg || f.beg < hz)) {
+			return -1;
+		}
+		nr = _rd_cpag(tgt, _s, &o, eo - f.beg);
+		if (UNLIKELY(nr <= 0)) {
+			return -1;
+		}
+		_s->ro = f.beg;
+	} else {
+		/* at the beginning */
+		return 0;
+	}
+	/* position is now at the oldest tick handed out */
+	_s->rt = 0U;
+	_rev_tsoa(tgt, nr, layo, nflds);
+	return nr;
+}
+
+int
+cots_asof(cots_ts_t s, cots_to_t t, struct cots_tick_s *tgt)
+{
+	struct _ss_s *_s = (void*)s;
+	const size_t nflds = _s->public.nfields;
+	const char *layo = _s->public.layout;
+	size_t n;
+	size_t k;
+
+	if (UNLIKELY(_s->fd < 0)) {
+		/* no backing file */
+		return -1;
+	} else if (_s->mwal && (n = _wal_rowi(_s->wal))) {
+		/* unflushed ticks are the most recent ones */
+		const size_t zrow = _s->wal->zrow;
+		const uint8_t *rows = _s->wal->data;
+		cots_to_t tm;
+
+		memcpy(&tm, rows, sizeof(tm));
+		if (tm <= t) {
+			/* find first row after T */
+			size_t lo = 0U, hi = n;
+
+			while (lo < hi) {
+				const size_t mid = (lo + hi) / 2U;
+
+				memcpy(&tm, rows + mid * zrow, sizeof(tm));
+				if (tm <= t) {
+					lo = mid + 1U;
+				} else {
+					hi = mid;
+				}
+			}
+			memcpy(tgt, rows + (lo - 1U) * zrow, zrow);
+			return 0;
+		}
+	}
+
+	if (UNLIKELY(_ld_pgd(_s) < 0)) {
+		return -1;
+	} else if (UNLIKELY(!_s->npgd || _s->pgd->from > t)) {
+		/* nothing that early */
+		return -1;
+	}
+	/* last page starting at or before T */
+	k = t < (cots_to_t)-1 ? _find_pgd(_s, t + 1U) : _s->npgd - 1U;
+	if (_s->apo != _s->pgd[k].beg) {
+		/* lookups tend to cluster, so keep the decoded page */
+		off_t o = _s->pgd[k].beg;
+		ssize_t nt;
+
+		if (_s->apg == NULL) {
+			const size_t z = sizeof(*_s->apg) + nflds * sizeof(void*);
+
+			if (UNLIKELY((_s->apg = malloc(z)) == NULL)) {
+				return -1;
+			} else if (UNLIKELY(cots_init_tsoa(_s->apg, s) < 0)) {
+				free(_s->apg);
+				_s->apg = NULL;
+				return -1;
+			}
+		}
+		nt = _rd_cpag(_s->apg, _s, &o, _s->pgd[k].end - o);
+		if (UNLIKELY(nt <= 0)) {
+			_s->apo = 0;
+			return -1;
+		}
+		_s->apo = _s->pgd[k].beg;
+		_s->apn = nt;
+	}
+	/* last tick at or before T, there's one as the page starts there */
+	n = t < (cots_to_t)-1
+		? _lbnd_to(_s->apg->toffs, _s->apn, t + 1U) : _s->apn;
+	_row_tick((uint8_t*)tgt, _s->apg, n - 1U, layo, nflds);
+	return 0;
+}
+
+static struct rsmp_s*
+_rs_init(struct _ss_s *_s, cots_to_t ival, cots_to_t from, cots_to_t till)
+{
+/* set up resampler, decoding only time, price and quantity columns */
+	const size_t nflds = _s->public.nfields;
+	const char *layo = _s->public.layout;
+	struct rsmp_s *rs = _s->rs;
+	uint64_t proj = 0U;
+
+	if (rs == NULL) {
+		if (UNLIKELY((rs = calloc(1, sizeof(*rs))) == NULL)) {
+			return NULL;
+		}
+		rs->pi = rs->qi = -1;
+		for (size_t i = 0U; i < nflds; i++) {
+			if (layo[i] == COTS_LO_PRC && rs->pi < 0) {
+				rs->pi = i;
+			} else if (layo[i] == COTS_LO_QTY && rs->qi < 0) {
+				rs->qi = i;
+			}
+		}
+		proj |= rs->pi >= 0 ? 1ULL << (rs->pi & 0x3fU) : 0U;
+		proj |= rs->qi >= 0 ? 1ULL << (rs->qi & 0x3fU) : 0U;
+		rs->pg = malloc(sizeof(*rs->pg) + nflds * sizeof(void*));
+		if (UNLIKELY(rs->pg == NULL)) {
+			free(rs);
+			return NULL;
+		} else if (UNLIKELY(cots_init_tsoa_proj(
+					    rs->pg, &_s->public, proj) < 0)) {
+			free(rs->pg);
+			free(rs);
+			return NULL;
+		}
+		_s->rs = rs;
+	}
+	rs->ival = ival;
+	rs->from = from;
+	rs->till = till;
+	rs->n = rs->i = 0U;
+	rs->eof = 0;
+	rs->b.nb = 0U;
+	/* make sure the range read starts afresh */
+	_s->rng = (struct trng_s){0U, 0U};
+	return rs;
+}
+
+ssize_t
+cots_resample(
+	cots_ts_t s, cots_to_t ival, cots_to_t from, cots_to_t till,
+	struct cots_tsoa_s *restrict out)
+{
+	struct _ss_s *_s = (void*)s;
+	const size_t blkz = _s->public.blockz;
+	struct rsmp_s *rs = _s->rs;
+	cots_px_t *o = out->cols[0U];
+	cots_px_t *h = out->cols[1U];
+	cots_px_t *l = out->cols[2U];
+	cots_px_t *c = out->cols[3U];
+	cots_qx_t *v = out->cols[4U];
+	size_t m = 0U;
+
+	if (UNLIKELY(!ival || from >= till)) {
+		return -1;
+	} else if (rs == NULL ||
+		   ival != rs->ival || from != rs->from || till != rs->till) {
+		/* new bars */
+		if (UNLIKELY((rs = _rs_init(_s, ival, from, till)) == NULL)) {
+			return -1;
+		}
+	}
+
+	while (m < blkz) {
+		const cots_px_t *px;
+		const cots_qx_t *qx;
+		cots_to_t bt;
+
+		if (rs->i >= rs->n) {
+			ssize_t nr;
+
+			if (rs->eof) {
+				break;
+			} else if (UNLIKELY((nr = cots_read_range(
+					     rs->pg, s, from, till)) < 0)) {
+				/* don't pass off a broken page as the end */
+				return -1;
+			} else if (!nr) {
+				rs->eof = 1;
+				if (!rs->b.nb) {
+					break;
+				}
+				/* last bar then */
+				goto emit;
+			}
+			rs->n = nr;
+			rs->i = 0U;
+		}
+		/* bars start at multiples of IVAL after FROM */
+		bt = rs->pg->toffs[rs->i];
+		bt = from + (bt - from) / ival * ival;
+		if (rs->b.nb && bt != rs->b.bt) {
+			goto emit;
+		} else if (!rs->b.nb) {
+			_bar_new(&rs->b, bt);
+		}
+		px = rs->pi >= 0 ? rs->pg->cols[rs->pi] : NULL;
+		qx = rs->qi >= 0 ? rs->pg->cols[rs->qi] : NULL;
+		_bar_add(&rs->b, px, qx, rs->i++);
+		continue;
+
+	emit:
+		out->toffs[m] = rs->b.bt;
+		o[m] = rs->b.o;
+		h[m] = rs->b.h;
+		l[m] = rs->b.l;
+		c[m] = rs->b.c;
+		v[m] = rs->b.v;
+		m++;
+		rs->b.nb = 0U;
+	}
+	return m;
+}
+
+cots_ts_t
+cots_rollup(cots_ts_t s, cots_to_t ival)
+{
+	struct _ss_s *_s = (void*)s;
+	struct rlp_s *r = NULL;
+
+	for (size_t k = 0U; k < _s->nrlp; k++) {
+		if (_s->rlp[k].ival == ival) {
+			r = _s->rlp + k;
+			break;
+		}
+	}
+	if (UNLIKELY(r == NULL)) {
+		return NULL;
+	} else if (r->ts == NULL && r->r.beg < r->r.end) {
+		/* companion within a frozen file, open it on its own
+		 * descriptor so it can be closed independently */
+		int fd;
+
+		if (UNLIKELY((fd = dup(_s->fd)) < 0)) {
+			return NULL;
+		} else if ((r->ts = _open_core(fd, r->r)) == NULL) {
+			close(fd);
+			return NULL;
+		}
+		_open_idx((void*)r->ts, r->r);
+	}
+	return r->ts;
+}
+
+int
+cots_seek(cots_ts_t s, cots_to_t from)
+{
+	struct _ss_s *_s = (void*)s;
+	const size_t nflds = _s->public.nfields;
+	struct {
+		struct cots_tsoa_s t;
+		void *cols[nflds];
+	} pg;
+	int rc = 0;
+
+	if (UNLIKELY(_s->fd < 0)) {
+		/* no backing file */
+		return -1;
+	} else if (UNLIKELY(_ld_pgd(_s) < 0)) {
+		return -1;
+	} else if (UNLIKELY(cots_init_tsoa_proj(&pg.t, s, 0U) < 0)) {
+		return -1;
+	}
+	/* any range reads will have to start over */
+	_s->rng = (struct trng_s){0U, 0U};
+
+	/* ticks not before FROM start on the last page that begins
+	 * before FROM or, should all of its ticks be before FROM, on
+	 * one of the pages thereafter */
+	for (size_t k = _find_pgd(_s, from); k < _s->npgd; k++) {
+		const struct pgde_s e = _s->pgd[k];
+		off_t o = e.beg;
+		ssize_t nt;
+		size_t rt;
+
+		nt = _rd_cpag(&pg.t, _s, &o, e.end - e.beg);
+		if (UNLIKELY(nt <= 0)) {
+			rc = -1;
+			goto fin_out;
+		} else if ((rt = _lbnd_to(pg.t.toffs, nt, from)) < (size_t)nt) {
+			_s->ro = e.beg;
+			_s->rt = rt;
+			goto fin_out;
+		}
+	}
+
+	/* FROM is beyond the compressed pages, try the WAL */
+	_s->ro = _s->fo;
+	_s->rt = 0U;
+	if (_s->wal != NULL && _s->mwal != NULL) {
+		const cots_to_t *tp = (const void*)_s->wal->data;
+		const size_t zrow = _s->wal->zrow / sizeof(*tp);
+		const size_t nt = _wal_rowi(_s->wal);
+
+		while (_s->rt < nt && tp[_s->rt * zrow] < from) {
+			_s->rt++;
+		}
+	}
+fin_out:
+	cots_fini_tsoa(&pg.t, s);
+	return rc;
+}
+
+ssize_t
+cots_count(cots_ts_t s, cots_to_t from, cots_to_t till)
+{
+	struct _ss_s *_s = (void*)s;
+	const size_t nflds = _s->public.nfields;
+	struct {
+		struct cots_tsoa_s t;
+		void *cols[nflds];
+	} pg;
+	ssize_t n = 0;
+
+	if (UNLIKELY(from >= till)) {
+		return 0;
+	} else if (_s->fd >= 0 && UNLIKELY(_ld_pgd(_s) < 0)) {
+		return -1;
+	} else if (UNLIKELY(cots_init_tsoa_proj(&pg.t, s, 0U) < 0)) {
+		return -1;
+	}
+
+	for (size_t k = _find_pgd(_s, from); k < _s->npgd; k++) {
+		const struct pgde_s e = _s->pgd[k];
+		off_t o = e.beg;
+		ssize_t nt;
+
+		if (e.from >= till) {
+			break;
+		} else if (e.from >= from &&
+			   k + 1U < _s->npgd && _s->pgd[k + 1U].from < till) {
+			/* ticks on page K are no later than the next page's
+			 * first tick, so it's covered entirely */
+			n += e.nt;
+			continue;
+		}
+		/* boundary page, time offsets will do */
+		nt = _rd_cpag(&pg.t, _s, &o, e.end - e.beg);
+		if (UNLIKELY(nt <= 0)) {
+			n = -1;
+			goto fin_out;
+		}
+		n += _lbnd_to(pg.t.toffs, nt, till);
+		n -= _lbnd_to(pg.t.toffs, nt, from);
+	}
+
+	/* ticks yet to be flushed */
+	if (_s->wal != NULL && _s->mwal != NULL) {
+		const cots_to_t *tp = (const void*)_s->wal->data;
+		const size_t zrow = _s->wal->zrow / sizeof(*tp);
+		const size_t nt = _wal_rowi(_s->wal);
+
+		for (size_t i = 0U; i < nt; i++) {
+			n += tp[i * zrow] >= from && tp[i * zrow] < till;
+		}
+	}
+fin_out:
+	cots_fini_tsoa(&pg.t, s);
+	return n;
+}
+
+ssize_t
+cots_read_range(
+	struct cots_tsoa_s *restrict tgt, cots_ts_t s,
+	cots_to_t from, cots_to_t till)
+{
+	struct _ss_s *_s = (void*)s;
+	ssize_t nr = 0;
+
+	if (UNLIKELY(from >= till)) {
+		/* nothing to read, and {0, 0} means no range at all */
+		return -1;
+	} else if (from != _s->rng.from || till != _s->rng.till) {
+		/* new range, position at FROM */
+		if (UNLIKELY(cots_seek(s, from) < 0)) {
+			return -1;
+		}
+		_s->rng = (struct trng_s){from, till};
+		/* we know which pages we're going to need */
+		if (_s->npgd && _s->ro < _s->fo) {
+			const struct pgde_s e = _s->pgd[_find_pgd(_s, till)];
+
+			if (e.end > _s->ro) {
+				_rd_want(_s, _s->ro, e.end - _s->ro);
+			}
+		}
+	}
+	/* don't bother decoding pages that start at or beyond TILL */
+	if (_s->npgd && !_s->rt) {
+		const ssize_t k = _find_pgo(_s, _s->ro);
+
+		if (k >= 0 && _s->pgd[k].from >= till) {
+			goto fin_out;
+		}
+	}
+	if ((nr = cots_read_ticks(tgt, s)) <= 0) {
+		/* range is done, the next call starts over */
+		_s->rng = (struct trng_s){0U, 0U};
+		return nr;
+	} else if (LIKELY(tgt->toffs[nr - 1] < till)) {
+		return nr;
+	}
+	/* clip, TILL is on this very page */
+	nr = _lbnd_to(tgt->toffs, nr, till);
+fin_out:
+	/* and stop reading */
+	_s->ro = _s->fo;
+	_s->rt = _s->wal && _s->mwal ? _wal_rowi(_s->wal) : 0U;
+	if (!nr) {
+		/* range is done, the next call starts over */
+		_s->rng = (struct trng_s){0U, 0U};
+	}
+	return nr;
+}
+
+ssize_t
+cots_read_filt(
+	struct cots_tsoa_s *restrict tgt, cots_ts_t s,
+	const struct cots_pred_s *p, size_t np)
+{
+	struct _ss_s *_s = (void*)s;
+	const size_t nflds = _s->public.nfields;
+	const size_t zz = _zone_z(_s->public.layout, nflds);
+	const char *layo = _s->public.layout;
+	size_t zo[np + !np];
+	ssize_t nr;
+
+	if (UNLIKELY(_s->fd < 0)) {
+		/* no backing file */
+		return -1;
+	}
+	for (size_t i = 0U; i < np; i++) {
+		if (UNLIKELY(p[i].fld >= nflds)) {
+			return -1;
+		} else if (UNLIKELY(!cots_zone_lo(layo[p[i].fld]))) {
+			/* can't compare those */
+			return -1;
+		} else if (UNLIKELY(tgt->cols[p[i].fld] == NULL)) {
+			/* we need to see the values */
+			return -1;
+		}
+		switch (p[i].op) {
+		case COTS_OP_LT:
+		case COTS_OP_LE:
+		case COTS_OP_GT:
+		case COTS_OP_GE:
+		case COTS_OP_EQ:
+			break;
+		default:
+			/* no idea what they want */
+			return -1;
+		}
+		zo[i] = _zone_off(layo, p[i].fld);
+	}
+	if (UNLIKELY(_ld_pgd(_s) < 0)) {
+		return -1;
+	}
+
+	do {
+		ssize_t k;
+		size_t m = 0U;
+
+		/* skip pages whose zone maps rule out a match */
+		while (!_s->rt && _s->ro < _s->fo &&
+		       (k = _find_pgo(_s, _s->ro)) >= 0 && _s->pgd[k].zoned) {
+			const uint8_t *z = _s->zon + k * zz;
+			size_t i;
+
+			for (i = 0U; i < np; i++) {
+				const char lo = layo[p[i].fld];
+				const size_t wid = _layo_wid(cots_zone_lo(lo));
+
+				if (!_zone_sat(lo, z + zo[i], z + zo[i] + wid,
+					       p + i)) {
+					break;
+				}
+			}
+			if (i < np) {
+				/* next page */
+				_s->ro = _s->pgd[k].end;
+				continue;
+			}
+			break;
+		}
+		if ((nr = cots_read_ticks(tgt, s)) <= 0) {
+			break;
+		}
+		/* filter ticks, compact the matching ones */
+		for (ssize_t j = 0; j < nr; j++) {
+			size_t i;
+
+			for (i = 0U; i < np; i++) {
+				const size_t fld = p[i].fld;
+				const size_t wid = _layo_wid(layo[fld]);
+				const uint8_t *v = tgt->cols[fld];
+
+				if (!_zone_sat(layo[fld],
+					       v + j * wid, v + j * wid, p + i)) {
+					break;
+				}
+			}
+			if (i < np) {
+				continue;
+			} else if ((size_t)j > m) {
+				tgt->toffs[m] = tgt->toffs[j];
+				for (size_t f = 0U; f < nflds; f++) {
+					const size_t wid = _layo_wid(layo[f]);
+					uint8_t *c = tgt->cols[f];
+
+					if (c == NULL) {
+						continue;
+					}
+					memcpy(c + m * wid, c + j * wid, wid);
+				}
+			}
+			m++;
+		}
+		nr = m;
+	} while (!nr);
+	return nr;
+}
+
+int
+cots_follow(cots_ts_t s)
 {
 	struct _ss_s *_s = (void*)s;
 
-	if (UNLIKELY(data->toff < _last_toff(_s))) {
-		/* can't go back in time */
+	if (UNLIKELY(_s->fd < 0 || _s->mdr == NULL)) {
+		/* no backing file */
+		return -1;
+	} else if (UNLIKELY(_s->mwal != NULL)) {
+		/* that's the writer, they know everything */
 		return -1;
 	}
-	/* otherwise bang, this is a wal routine */
-	_wal_bang(_s->wal, data);
+	/* the writer might not have started yet, try again later then */
+	_s->fwal = _flw_wal(_s);
+	_s->flw = 1;
 	return 0;
 }
 
 int
-cots_keep_last(cots_ts_t s)
+cots_stats_enable(cots_ts_t s, int on)
 {
 	struct _ss_s *_s = (void*)s;
-	const size_t blkz = _s->public.blockz;
-	int rc = 0;
+	struct st_s *st = NULL;
 
-	if (UNLIKELY(_wal_rinc(_s->wal) == blkz)) {
-		/* just for now */
-		if (!_s->idx) {
-			_s->idx = make_cots_idx(_s->public.filename);
+	if (!on) {
+		;
+	} else if (_s->st != NULL) {
+		/* keep counting */
+		return 0;
+	} else if (UNLIKELY((st = _make_st(_s->public.nfields)) == NULL)) {
+		return -1;
+	}
+	if (_s->cw != NULL) {
+		/* the worker mustn't be accounting a page meanwhile */
+		pthread_mutex_lock(&_s->cw->mtx);
+		while (_s->cw->busy) {
+			pthread_cond_wait(&_s->cw->cnd, &_s->cw->mtx);
 		}
-		/* auto-eviction */
-		rc = _flush(_s);
 	}
-	return rc;
+	with (struct st_s *old = _s->st) {
+		_s->st = st;
+		st = old;
+	}
+	if (_s->cw != NULL) {
+		pthread_mutex_unlock(&_s->cw->mtx);
+	}
+	free(st);
+	return 0;
 }
 
+int
+cots_stats(cots_ts_t s, struct cots_stats_s *tgt)
+{
+	const struct _ss_s *_s = (const void*)s;
+
+	if (UNLIKELY(_s->st == NULL)) {
+		return -1;
+	} else if (_s->cw != NULL) {
+		/* the page in flight counts as written as well */
+		pthread_mutex_lock(&_s->cw->mtx);
+		*tgt = _s->st->pub;
+		tgt->nticks += _s->cw->nt;
+		pthread_mutex_unlock(&_s->cw->mtx);
+	} else {
+		*tgt = _s->st->pub;
+	}
+	/* ticks still in the WAL count as written */
+	if (_s->wal != NULL) {
+		tgt->nticks += _wal_rowi(_s->wal);
+	}
+	return 0;
+}
 
 int
-cots_write_tick(cots_ts_t s, const struct cots_tick_s *data)
+cots_page_cache(size_t budget)
 {
-	return !(cots_bang_tick(s, data) < 0)
-		? cots_keep_last(s)
-		: -1;
+	pcache_budget(budget);
+	return 0;
 }
 
 int
-cots_write_va(cots_ts_t s, cots_to_t t, ...)
+cots_prefetch(cots_ts_t s, size_t npages)
 {
 	struct _ss_s *_s = (void*)s;
-	const char *flds = _s->public.layout;
 	const size_t nflds = _s->public.nfields;
-	uint8_t rp[_s->wal->zrow] __attribute__((aligned(16)));
-	va_list vap;
+	struct pf_s *pf;
 
-	with (cots_to_t *tp = (void*)rp) {
-		*tp = t;
+	/* retire any old worker first */
+	_pf_stop(_s);
+	if (!npages) {
+		return 0;
+	} else if (UNLIKELY(_s->fd < 0)) {
+		/* no backing file */
+		return -1;
 	}
-	va_start(vap, t);
-	for (size_t i = 0U, a = _layo_zrow(flds, i), wid = 0U; i < nflds; i++) {
-		/* get current field's width and alignment */
-		a += wid, wid = _layo_wid(flds[i]), a = _layo_algn(a, wid);
-
-		switch (wid) {
-		case 1U:
-		case 2U:
-		case 4U: {
-			uint32_t *cp = (uint32_t*)(rp + a);
-			*cp = va_arg(vap, uint32_t);
-			break;
+	pf = calloc(1, sizeof(*pf) + npages * sizeof(*pf->sl));
+	if (UNLIKELY(pf == NULL)) {
+		return -1;
+	}
+	pf->nsl = npages;
+	_rd_init(&pf->rw, _s);
+	for (size_t i = 0U; i < npages; i++) {
+		struct cots_tsoa_s *t;
+
+		t = malloc(sizeof(*t) + nflds * sizeof(*t->cols));
+		if (UNLIKELY(t == NULL)) {
+			goto nomem;
+		} else if (UNLIKELY(cots_init_tsoa(t, s) < 0)) {
+			free(t);
+			goto nomem;
 		}
+		pf->sl[i].t = t;
+	}
+	/* give the worker a head start */
+	pf->o = _s->ro;
+	pf->eo = _s->fo;
+	pthread_mutex_init(&pf->mtx, NULL);
+	pthread_cond_init(&pf->cnd, NULL);
+	_s->pf = pf;
+	if (UNLIKELY(pthread_create(&pf->th, NULL, _pf_work, _s))) {
+		pthread_cond_destroy(&pf->cnd);
+		pthread_mutex_destroy(&pf->mtx);
+		_s->pf = NULL;
+		goto nomem;
+	}
+	return 0;
 
-		case 8U: {
-			uint64_t *cp = (uint64_t*)(rp + a);
-			*cp = va_arg(vap, uint64_t);
+nomem:
+	_pf_free(pf, s);
+	return -1;
+}
+
+static void*
+_scan_work(void *clo)
+{
+/* decode pages handed out by the page counter and feed them to CB */
+	struct scan_s *sc = clo;
+	struct _ss_s *_s = sc->_s;
+	const size_t nflds = _s->public.nfields;
+	struct rwin_s rw;
+	struct {
+		struct cots_tsoa_s t;
+		void *cols[nflds];
+	} pg;
+	size_t k;
+
+	if (UNLIKELY(cots_init_tsoa(&pg.t, &_s->public) < 0)) {
+		__atomic_store_n(&sc->err, 1, __ATOMIC_RELAXED);
+		__atomic_store_n(&sc->stop, 1, __ATOMIC_RELAXED);
+		return NULL;
+	}
+	_rd_init(&rw, _s);
+	while (!__atomic_load_n(&sc->stop, __ATOMIC_RELAXED) &&
+	       (k = __atomic_fetch_add(&sc->next, 1U, __ATOMIC_RELAXED)) <
+	       _s->npgd) {
+		const struct pgde_s e = _s->pgd[k];
+		off_t o = e.beg;
+		ssize_t nt;
+
+		nt = _rd_cpag_w(&pg.t, _s, &rw, &o, e.end - e.beg);
+		if (UNLIKELY(nt <= 0)) {
+			__atomic_store_n(&sc->err, 1, __ATOMIC_RELAXED);
+			__atomic_store_n(&sc->stop, 1, __ATOMIC_RELAXED);
 			break;
-		}
-		default:
+		} else if (sc->cb(&pg.t, nt, k, sc->clo)) {
+			/* the page CB stopped at doesn't count */
+			__atomic_store_n(&sc->stop, 1, __ATOMIC_RELAXED);
 			break;
 		}
+		__atomic_fetch_add(&sc->nt, nt, __ATOMIC_RELAXED);
 	}
-	va_end(vap);
-
-	return cots_write_tick(s, (const void*)rp);
+	cots_fini_tsoa(&pg.t, &_s->public);
+	_rd_unmap(&rw);
+	return NULL;
 }
 
 int
-cots_init_tsoa(struct cots_tsoa_s *restrict tgt, cots_ts_t s)
+cots_uring(cots_ts_t s, size_t depth)
 {
-	const size_t blkz = s->blockz;
-	const size_t nflds = s->nfields;
-	void *rb = calloc(sizeof(uint64_t) * (nflds + 1U), blkz);
+	struct _ss_s *_s = (void*)s;
+	const size_t pgsz = mmap_pgsz();
+	struct ur_s *ur;
+	size_t bufz = 0U;
 
-	if (UNLIKELY((tgt->toffs = (cots_to_t*)rb) == NULL)) {
+	/* tear down any old ring first */
+	_ur_stop(_s);
+	if (!depth) {
+		return 0;
+	} else if (UNLIKELY(_s->fd < 0)) {
+		/* no backing file */
+		return -1;
+	} else if (UNLIKELY(_ld_pgd(_s) < 0)) {
 		return -1;
 	}
-	for (size_t i = 0U; i < nflds; i++) {
-		tgt->cols[i] = tgt->toffs + (i + 1U) * blkz;
+	/* buffers must hold the largest page */
+	for (size_t i = 0U; i < _s->npgd; i++) {
+		bufz = max_z(bufz, _s->pgd[i].end - _s->pgd[i].beg);
 	}
-	return 0;
-}
+	bufz = max_z((bufz + pgsz - 1U) & ~(pgsz - 1U), pgsz);
 
-int
-cots_fini_tsoa(struct cots_tsoa_s *restrict tgt, cots_ts_t UNUSED(s))
-{
-	if (UNLIKELY(tgt->toffs == NULL)) {
+	ur = calloc(1U, sizeof(*ur) + depth * sizeof(*ur->res));
+	if (UNLIKELY(ur == NULL)) {
 		return -1;
 	}
-	free(tgt->toffs);
+	ur->r = make_uring(_s->fd, depth, bufz);
+	if (UNLIKELY(ur->r == NULL)) {
+		/* no io_uring for us */
+		free(ur);
+		return -1;
+	}
+	ur->nsl = depth;
+	ur->bufz = bufz;
+	_s->ur = ur;
 	return 0;
 }
 
 ssize_t
-cots_read_ticks(struct cots_tsoa_s *restrict tgt, cots_ts_t s)
+cots_scan_parallel(cots_ts_t s, size_t nthreads, cots_scan_f cb, void *clo)
 {
-/* currently this is mmap only */
 	struct _ss_s *_s = (void*)s;
-	const size_t blkz = _s->public.blockz;
-	const size_t nflds = _s->public.nfields;
-	const char *layo = _s->public.layout;
-	size_t mz;
-	size_t nr;
+	struct scan_s sc = {._s = _s, .cb = cb, .clo = clo};
+	size_t nth;
 
 	if (UNLIKELY(_s->fd < 0)) {
 		/* no backing file */
 		return -1;
-	} else if (UNLIKELY(_s->ro >= _s->fo) && _s->mwal) {
-		/* no compressed ticks on their pages, innit? */
-		goto _wal_read_ticks;
-	} else if (UNLIKELY(_s->ro >= _s->fo)) {
-		return 0;
+	} else if (UNLIKELY(_ld_pgd(_s) < 0)) {
+		return -1;
 	}
+	if (!nthreads) {
+		long nproc = sysconf(_SC_NPROCESSORS_ONLN);
+		nthreads = nproc > 0 ? nproc : 1U;
+	}
+	/* no point in having more workers than pages */
+	nthreads = min_z(nthreads, _s->npgd);
 
-	/* guesstimate the page that needs mapping */
-	mz = min_z(_s->fo - _s->ro, blkz * nflds * sizeof(uint64_t));
-	/* and read/decomp the page */
-	nr = _rd_cpag(tgt, _s->fd, &_s->ro, mz, layo, nflds);
-	if (LIKELY(!_s->rt)) {
-		return nr;
+	with (pthread_t th[nthreads ?: 1U]) {
+		for (nth = 0U; nth < nthreads; nth++) {
+			if (pthread_create(th + nth, NULL, _scan_work, &sc)) {
+				break;
+			}
+		}
+		if (UNLIKELY(!nth && nthreads)) {
+			/* not even one worker, do it ourselves */
+			_scan_work(&sc);
+		}
+		for (size_t i = 0U; i < nth; i++) {
+			pthread_join(th[i], NULL);
+		}
 	}
-	/* otherwise it's extra-time, kill the first _s->rt ticks then */
-	assert(_s->rt <= nr);
-	/* adapt result value */
-	nr -= _s->rt;
-	/* start with the time offsets */
-	memmove(tgt->toffs, tgt->toffs + _s->rt, nr * sizeof(*tgt->toffs));
-	for (size_t i = 0U; i < nflds; i++) {
-		uint8_t *tp = tgt->cols[i];
-		const size_t wid = _layo_wid(layo[i]);
-		memmove(tp, tp + _s->rt * wid, nr * wid);
+	if (UNLIKELY(sc.err)) {
+		return -1;
+	} else if (!sc.stop && _s->mwal) {
+		/* ticks yet to be flushed form the last batch */
+		const off_t ro = _s->ro;
+		const size_t rt = _s->rt;
+		const size_t nflds = _s->public.nfields;
+		struct {
+			struct cots_tsoa_s t;
+			void *cols[nflds];
+		} pg;
+		ssize_t nt;
+
+		if (UNLIKELY(cots_init_tsoa(&pg.t, s) < 0)) {
+			return -1;
+		}
+		_s->ro = _s->fo;
+		_s->rt = 0U;
+		if ((nt = cots_read_ticks(&pg.t, s)) > 0 &&
+		    !cb(&pg.t, nt, _s->npgd, clo)) {
+			sc.nt += nt;
+		}
+		_s->ro = ro;
+		_s->rt = rt;
+		cots_fini_tsoa(&pg.t, s);
 	}
-	_s->rt += nr;
-	_s->rt &= (blkz - 1U);
-	return nr;
+	return sc.nt;
+}
 
-_wal_read_ticks:
-	nr = _wal_rowi(_s->mwal);
-	size_t nt = _wal_rowi(_s->wal);
+
+/* merging */
+struct msrc_s {
+	cots_ts_t s;
+	/* read cursor into and fill of buffer T */
+	size_t i;
+	size_t n;
+	struct cots_tsoa_s *t;
+};
 
-	if (nt > nr) {
-		struct {
-			struct cots_tsoa_s proto;
-			void *cols[nflds];
-		} cols;
+struct cots_mrg_s {
+	size_t nsrc;
+	/* heap of sources by their heads */
+	size_t *h;
+	size_t nh;
+	/* whether sources have been primed */
+	int primed;
+	struct msrc_s src[];
+};
+
+static inline __attribute__((pure)) int
+_msrc_lt(const struct cots_mrg_s *m, size_t k, size_t q)
+{
+/* whether the head of source K comes before the one of Q */
+	const struct msrc_s *sk = m->src + k;
+	const struct msrc_s *sq = m->src + q;
+	const cots_to_t tk = sk->t->toffs[sk->i];
+	const cots_to_t tq = sq->t->toffs[sq->i];
 
-		/* imprint standard layout on COLS tsoa */
-		_layo_impr(&cols.proto, _s->mwal->data, layo, nflds, blkz);
+	return tk < tq || (tk == tq && k < q);
+}
 
-		/* columnify again */
-		_bang_tick(&cols.proto, _s->wal->data, nt, layo, nflds, nr);
-		_wal_rset(_s->mwal, nt);
-	} else if (UNLIKELY(_s->rt >= nr)) {
-		return 0;
+static void
+_mrg_sift(struct cots_mrg_s *m, size_t j)
+{
+/* sift heap element J down */
+	size_t *h = m->h;
+
+	for (size_t c; (c = 2U * j + 1U) < m->nh; j = c) {
+		if (c + 1U < m->nh && _msrc_lt(m, h[c + 1U], h[c])) {
+			c++;
+		}
+		if (!_msrc_lt(m, h[c], h[j])) {
+			break;
+		}
+		with (size_t x = h[c]) {
+			h[c] = h[j], h[j] = x;
+		}
+	}
+	return;
+}
+
+static void
+_mrg_push(struct cots_mrg_s *m, size_t k)
+{
+	size_t *h = m->h;
+	size_t j;
+
+	for (j = m->nh++; j > 0U && _msrc_lt(m, k, h[(j - 1U) / 2U]);
+	     j = (j - 1U) / 2U) {
+		h[j] = h[(j - 1U) / 2U];
+	}
+	h[j] = k;
+	return;
+}
+
+static ssize_t
+_msrc_fill(struct msrc_s *src)
+{
+	ssize_t n = cots_read_ticks(src->t, src->s);
+
+	src->i = 0U;
+	src->n = n > 0 ? n : 0U;
+	return n;
+}
+
+static int
+_mrg_prime(struct cots_mrg_s *m, const struct cots_tsoa_s *tgt)
+{
+/* set up buffers of all sources, projected like TGT */
+	const size_t nflds = m->src->s->nfields;
+	uint64_t proj = 0U;
+
+	for (size_t i = 0U; i < nflds && i < 64U; i++) {
+		proj |= (uint64_t)(tgt->cols[i] != NULL) << i;
 	}
-	/* we'd be writing NT ticks, offset at _S->RT */
-	nt -= _s->rt;
-	/* time vector first */
-	with (const uint8_t *sp = _s->mwal->data) {
-		const size_t wid = sizeof(*tgt->toffs);
-		memcpy(tgt->toffs, sp + _s->rt * wid, nt * wid);
+	for (size_t k = 0U; k < m->nsrc; k++) {
+		struct msrc_s *src = m->src + k;
+		struct cots_tsoa_s *t;
+
+		t = malloc(sizeof(*t) + nflds * sizeof(*t->cols));
+		if (UNLIKELY(t == NULL)) {
+			return -1;
+		} else if (UNLIKELY(cots_init_tsoa_proj(t, src->s, proj) < 0)) {
+			free(t);
+			return -1;
+		}
+		src->t = t;
+		if (UNLIKELY(_msrc_fill(src) < 0)) {
+			return -1;
+		} else if (src->n) {
+			_mrg_push(m, k);
+		}
 	}
-	for (size_t i = 0U, a = _layo_zrow(layo, i), wid = 0U; i < nflds; i++) {
-		const uint8_t *sp;
+	m->primed = 1;
+	return 0;
+}
+
+cots_mrg_t
+make_cots_mrg(cots_ts_t const *ts, size_t n)
+{
+	struct cots_mrg_s *m;
 
-		a += wid, wid = _layo_wid(layo[i]), a = _layo_algn(a, wid);
-		sp = _s->mwal->data + a * blkz;
-		memcpy(tgt->cols[i], sp + _s->rt * wid, nt * wid);
+	if (UNLIKELY(!n)) {
+		return NULL;
 	}
-	_s->rt += nt;
-	return nt;
+	for (size_t k = 1U; k < n; k++) {
+		if (UNLIKELY(strcmp(ts[k]->layout, ts[0U]->layout))) {
+			/* can't merge apples and oranges */
+			return NULL;
+		}
+	}
+	m = calloc(1U, sizeof(*m) + n * sizeof(*m->src));
+	if (UNLIKELY(m == NULL)) {
+		return NULL;
+	} else if (UNLIKELY((m->h = calloc(n, sizeof(*m->h))) == NULL)) {
+		free(m);
+		return NULL;
+	}
+	for (size_t k = 0U; k < n; k++) {
+		m->src[k].s = ts[k];
+	}
+	m->nsrc = n;
+	return m;
+}
+
+void
+free_cots_mrg(cots_mrg_t m)
+{
+	for (size_t k = 0U; k < m->nsrc; k++) {
+		if (m->src[k].t != NULL) {
+			cots_fini_tsoa(m->src[k].t, m->src[k].s);
+			free(m->src[k].t);
+		}
+	}
+	free(m->h);
+	free(m);
+	return;
+}
+
+ssize_t
+cots_read_mrg(
+	struct cots_tsoa_s *restrict tgt, size_t *restrict src, cots_mrg_t m)
+{
+	const size_t nflds = m->src->s->nfields;
+	const size_t blkz = m->src->s->blockz;
+	const char *layo = m->src->s->layout;
+	size_t nr = 0U;
+
+	if (UNLIKELY(!m->primed && _mrg_prime(m, tgt) < 0)) {
+		return -1;
+	}
+	while (nr < blkz && m->nh) {
+		/* pop the earliest source */
+		const size_t k = *m->h;
+		struct msrc_s *sk = m->src + k;
+		size_t run = 1U;
+
+		m->h[0U] = m->h[--m->nh];
+		_mrg_sift(m, 0U);
+
+		/* it's got the stage until the runner-up's head */
+		for (sk->i++; sk->i < sk->n && nr + run < blkz &&
+			     (!m->nh || _msrc_lt(m, k, *m->h)); sk->i++) {
+			run++;
+		}
+		with (const size_t i0 = sk->i - run) {
+			memcpy(tgt->toffs + nr, sk->t->toffs + i0,
+			       run * sizeof(*tgt->toffs));
+			for (size_t i = 0U; i < nflds; i++) {
+				const size_t wid = _layo_wid(layo[i]);
+				uint8_t *tp = tgt->cols[i];
+				const uint8_t *sp = sk->t->cols[i];
+
+				if (tp == NULL) {
+					/* not projected */
+					continue;
+				}
+				memcpy(tp + nr * wid, sp + i0 * wid, run * wid);
+			}
+		}
+		for (size_t i = 0U; src != NULL && i < run; i++) {
+			src[nr + i] = k;
+		}
+		nr += run;
+
+		if (sk->i >= sk->n && UNLIKELY(_msrc_fill(sk) < 0)) {
+			return -1;
+		} else if (sk->i < sk->n) {
+			_mrg_push(m, k);
+		}
+	}
+	return nr;
 }
 
 
@@ -1672,6 +5117,31 @@ _bang_fields(struct _ss_s *_s, const char *flds, size_t fldz)
 	return 0;
 }
 
+static int
+_bang_rlps(struct _ss_s *_s, const uint8_t *rd, size_t rdz)
+{
+/* rollup directory, triples of interval and the companion's range */
+	const size_t n = rdz / (3U * sizeof(uint64_t));
+	struct rlp_s *rlp;
+
+	if (UNLIKELY(!n || _s->nrlp)) {
+		/* nothing to do or we know already */
+		return -1;
+	} else if (UNLIKELY((rlp = calloc(n, sizeof(*rlp))) == NULL)) {
+		return -1;
+	}
+	for (size_t k = 0U; k < n; k++) {
+		uint64_t x[3U];
+
+		memcpy(x, rd + k * sizeof(x), sizeof(x));
+		rlp[k].ival = be64toh(x[0U]);
+		rlp[k].r = (struct orng_s){be64toh(x[1U]), be64toh(x[2U])};
+	}
+	_s->rlp = rlp;
+	_s->nrlp = n;
+	return 0;
+}
+
 int
 cots_put_fields(cots_ts_t s, const char **fields)
 {
@@ -1721,11 +5191,67 @@ cots_put_fields(cots_ts_t s, const char **fields)
 	return 0;
 }
 
+int
+cots_put_rollups(cots_ts_t s, const cots_to_t *ivals, size_t n)
+{
+	struct _ss_s *_s = (void*)s;
+	const char *fn = _s->public.filename;
+	struct rlp_s *rlp;
+
+	if (_s->nrlp) {
+		/* rollups are set in stone, the same ones are fine though */
+		if (n != _s->nrlp) {
+			return -1;
+		}
+		for (size_t k = 0U; k < n; k++) {
+			if (ivals[k] != _s->rlp[k].ival) {
+				return -1;
+			}
+		}
+		return 0;
+	} else if (UNLIKELY(fn == NULL || _s->fl == O_RDONLY)) {
+		/* companions need a file to live next to */
+		return -1;
+	} else if (UNLIKELY(!n)) {
+		return 0;
+	} else if (UNLIKELY(_s->fo > (off_t)_hdrz(_s))) {
+		/* pages out already, their ticks would be missed */
+		return -1;
+	}
+	for (size_t k = 0U; k < n; k++) {
+		if (UNLIKELY(!ivals[k])) {
+			return -1;
+		}
+	}
+	if (UNLIKELY((rlp = calloc(n, sizeof(*rlp))) == NULL)) {
+		return -1;
+	}
+	_s->rlp = rlp;
+	_s->nrlp = n;
+	for (size_t k = 0U; k < n; k++) {
+		rlp[k].ival = ivals[k];
+		if (UNLIKELY((rlp[k].ts = _rlp_make(_s, k)) == NULL)) {
+			_free_rlp(_s);
+			return -1;
+		}
+	}
+	return 0;
+}
+
 cots_tag_t
 cots_tag(cots_ts_t s, const char *str, size_t len)
 {
 	struct _ss_s *_s = (void*)s;
-	return cots_intern(_s->ob, str, len);
+	cots_tag_t res;
+
+	if (_s->cw == NULL) {
+		return cots_intern(_s->ob, str, len);
+	}
+	/* the compaction worker might be writing out the obarray */
+	pthread_mutex_lock(&_s->cw->mtx);
+	res = cots_intern(_s->ob, str, len);
+	pthread_mutex_unlock(&_s->cw->mtx);
+	return res;
 }
 
 const char*
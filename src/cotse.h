@@ -127,6 +127,41 @@ struct cots_tsoa_s {
 	void *cols[];
 };
 
+/**
+ * Latency histogram, durations are in nanoseconds.
+ * Bucket I counts events that took [2^I, 2^(I+1)) nanoseconds,
+ * the last bucket counts anything longer too. */
+#define COTS_HISTZ	(40U)
+struct cots_hist_s {
+	uint64_t n;
+	uint64_t sum;
+	uint64_t h[COTS_HISTZ];
+};
+
+/**
+ * Series statistics, as filled in by `cots_stats()'. */
+struct cots_stats_s {
+	/** ticks written, including those not yet flushed */
+	size_t nticks;
+	/** pages flushed and their total size in octets */
+	size_t npages;
+	uint64_t pagez;
+	/** octets per column before and after compaction, NCOLS entries
+	 * each, the time column goes first.
+	 * These are owned and kept up to date by the series. */
+	size_t ncols;
+	const uint64_t *rawz;
+	const uint64_t *compz;
+	/** time spent flushing pages, compacting them and writing them */
+	struct cots_hist_s flush;
+	struct cots_hist_s comp;
+	struct cots_hist_s write;
+	/** time spent decoding pages */
+	struct cots_hist_s dcmp;
+	/** pages read bypassing the page cache, see `cots_open_ts()' */
+	size_t ndirect;
+};
+
 
 /* public API */
 /**
@@ -149,7 +184,10 @@ extern int cots_attach(cots_ts_t, const char *file, int flags);
 extern int cots_detach(cots_ts_t);
 
 /**
- * Open a cots-ts file. */
+ * Open a cots-ts file.
+ * For read-only handles FLAGS may include O_DIRECT in which case pages
+ * are read through aligned buffers bypassing the page cache, should the
+ * file system not support that pages are read the usual way. */
 extern cots_ts_t cots_open_ts(const char *file, int flags);
 
 /**
@@ -171,6 +209,14 @@ extern const char *cots_str(cots_ts_t, cots_tag_t);
  * An old array of fields in TS will be overwritten. */
 extern int cots_put_fields(cots_ts_t, const char **fields);
 
+/**
+ * Maintain rollups of TS, one series of OHLCV bars (see `cots_resample()')
+ * for each of the N intervals in IVALS, bars starting at multiples of
+ * the interval.  Rollups are brought up to date whenever a page is
+ * flushed and stored alongside the index when the series is frozen.
+ * TS must be attached to a file and have no pages flushed yet. */
+extern int cots_put_rollups(cots_ts_t, const cots_to_t *ivals, size_t n);
+
 
 /**
  * Bang data tick to series.
@@ -193,15 +239,79 @@ extern int cots_write_tick(cots_ts_t, const struct cots_tick_s*);
 
 /**
  * Write N data ticks to series.
- * The actual length of the tick is determined by the series' layout */
+ * The actual length of the tick is determined by the series' layout,
+ * ticks are laid out back to back.  Ticks must be in time order,
+ * otherwise none of them is written and -1 is returned. */
 extern int cots_write_ticks(cots_ts_t, const struct cots_tick_s*, size_t n);
 
+/**
+ * Write the first N ticks of a tsoa to series.
+ * Whole pages are compacted straight from the tsoa's columns, any
+ * remainder goes through the WAL like `cots_write_ticks()' would.
+ * Ticks must be in time order and the tsoa mustn't be projected,
+ * otherwise none of them is written and -1 is returned. */
+extern int cots_write_tsoa(cots_ts_t, const struct cots_tsoa_s*, size_t n);
+
+/**
+ * Durability policies, to be or'd together.
+ * COTS_SYNC_WAL syncs the WAL every NTICKS ticks or every USEC
+ * microseconds, whichever comes first, or after every tick if both
+ * are 0, and the file after every page written, before the WAL is
+ * reused.  The USEC deadline is checked upon writing only, ticks of a
+ * series that's gone quiet stay unsynced until the next write.
+ * Ticks in the WAL of a writer that died without detaching are
+ * appended when the file is next opened for writing.
+ * COTS_SYNC_PAGE syncs the file after every page written,
+ * COTS_SYNC_GROUP does so too but shares syncs with other series of
+ * the process that are flushing pages at the same time. */
+#define COTS_SYNC_NONE	(0U)
+#define COTS_SYNC_WAL	(1U)
+#define COTS_SYNC_PAGE	(2U)
+#define COTS_SYNC_GROUP	(4U)
+
+/**
+ * Set the durability policy HOW of a series, see COTS_SYNC_*.
+ * By default (COTS_SYNC_NONE) writing back is left to the kernel. */
+extern int
+cots_durability(cots_ts_t, unsigned int how, size_t nticks, uint64_t usec);
+
+/**
+ * Flush full pages in a worker thread if ON is non-0.
+ * `cots_keep_last()' then hands a full WAL to the worker and carries on
+ * with an empty one, waiting only if the previous page is still being
+ * flushed, errors of which are reported by the next hand-over.
+ * Until the worker is stopped by ON of 0, or by detaching the series,
+ * the series must not be read through the same handle.
+ * The page in flight is held in memory only, should the process die
+ * before it lands its ticks are lost, no matter the durability policy. */
+extern int cots_async_flush(cots_ts_t, int on);
+
+/**
+ * Write pages with block directories if ON is non-0, or without.
+ * Directories let reads start at the 128-tick block holding a row
+ * rather than at the top of its page, which speeds up seeks and reads
+ * resumed mid-page, at the expense of about 3kB per page of 8192 ticks
+ * of layout "qp", i.e. a fifth of its compressed size.
+ * The choice is recorded in the file so later writers stick with it,
+ * series without file take it to the file they are attached to.
+ * By default pages go without directories. */
+extern int cots_block_dirs(cots_ts_t, int on);
+
 /**
  * Initialise user tsoa (struct-of-arrays) for reading.
  * After initialisation `cots_read_ticks()' can be used and
  * when no longer required `cots_fini_tsoa()' must be called. */
 extern int cots_init_tsoa(struct cots_tsoa_s *restrict, cots_ts_t);
 
+/**
+ * Like `cots_init_tsoa()' but only for the columns set in bitmask PROJ,
+ * the least significant bit corresponding to the first field.
+ * Columns not in PROJ are set to NULL and `cots_read_ticks()' will skip
+ * them without decoding; so will it skip any other NULL column.
+ * Time offsets and fields beyond the 64th are always read. */
+extern int
+cots_init_tsoa_proj(struct cots_tsoa_s *restrict, cots_ts_t, uint64_t proj);
+
 /**
  * Free resources associated with the user tsoa. */
 extern int cots_fini_tsoa(struct cots_tsoa_s *restrict, cots_ts_t);
@@ -211,6 +321,230 @@ extern int cots_fini_tsoa(struct cots_tsoa_s *restrict, cots_ts_t);
  * TGT must be initialised using `cots_init_tsoa()' before first call. */
 extern ssize_t cots_read_ticks(struct cots_tsoa_s *restrict tgt, cots_ts_t);
 
+/**
+ * Like `cots_read_ticks()' but read as many whole pages as fit into
+ * the N ticks TGT's columns can hold.
+ * TGT's time offsets and columns must be provided by the caller,
+ * NULL columns are skipped without decoding.
+ * The page that fills TGT up is bounced through an internal buffer
+ * unless 64 more ticks fit behind it.
+ * Return the number of ticks read, 0 when the series is exhausted,
+ * -1 if not even the next page fits. */
+extern ssize_t
+cots_read_ticks_n(struct cots_tsoa_s *restrict tgt, cots_ts_t, size_t n);
+
+/**
+ * Read data ticks preceding the current read position from series,
+ * newest first, output to TGT.  The read position moves back to the
+ * oldest tick output.
+ * To read from the tail use `cots_seek()' with (cots_to_t)-1 first.
+ * TGT must be initialised using `cots_init_tsoa()' before first call. */
+extern ssize_t
+cots_read_ticks_rev(struct cots_tsoa_s *restrict tgt, cots_ts_t);
+
+/**
+ * Look up the last tick at or before T and output it to TGT.
+ * The actual length of the tick is determined by the series' layout.
+ * Return 0 on success, -1 if there is no such tick. */
+extern int cots_asof(cots_ts_t, cots_to_t t, struct cots_tick_s *tgt);
+
+/**
+ * Compute OHLCV bars of the ticks within [FROM, TILL), one for each
+ * interval of length IVAL (starting at FROM) that has ticks.
+ * Prices are taken from the first price field, volumes are sums of
+ * the first quantity field or, without one, the number of ticks.
+ * OUT's time offsets are the bars' start times, its columns must hold
+ * open, high, low and close prices (cots_px_t) and volumes (cots_qx_t)
+ * for as many bars as the series' block size.
+ * The first call positions the series at FROM, subsequent calls with
+ * the same arguments continue, return 0 when all bars have been output
+ * or -1 if the ticks cannot be read. */
+extern ssize_t
+cots_resample(cots_ts_t, cots_to_t ival, cots_to_t from, cots_to_t till,
+	      struct cots_tsoa_s *restrict out);
+
+/**
+ * Return the rollup series of TS with bars of length IVAL, or NULL if
+ * there's none.  Its layout is "ppppq", open, high, low and close
+ * prices and volumes, the series is owned by TS and remains valid
+ * until TS is detached. */
+extern cots_ts_t cots_rollup(cots_ts_t, cots_to_t ival);
+
+/**
+ * Position series for reading at the first tick not before FROM.
+ * Subsequent calls to `cots_read_ticks()' will start there.
+ * Pages are located through the index, if any.
+ * Return 0 on success, -1 otherwise. */
+extern int cots_seek(cots_ts_t, cots_to_t from);
+
+/**
+ * Read ticks within [FROM, TILL) from series, output to TGT.
+ * The first call positions the series at FROM, subsequent calls with
+ * the same range continue where the last one left off and return 0
+ * once TILL has been reached, the call after that starts over.
+ * Calls to `cots_seek()' start over too.
+ * Return -1 if FROM is not before TILL.
+ * TGT must be initialised using `cots_init_tsoa()' before first call. */
+extern ssize_t
+cots_read_range(struct cots_tsoa_s *restrict tgt, cots_ts_t,
+		cots_to_t from, cots_to_t till);
+
+/**
+ * Return the number of ticks within [FROM, TILL).
+ * Counts of pages entirely within the range are taken from the index,
+ * only the time offsets of the boundary pages are decoded.
+ * Return -1 on error. */
+extern ssize_t cots_count(cots_ts_t, cots_to_t from, cots_to_t till);
+
+/**
+ * Predicates on field values for `cots_read_filt()'. */
+struct cots_pred_s {
+	/** field index, 0 being the first field after the time offset */
+	size_t fld;
+	/** one of the COTS_OP_* operators */
+	int op;
+	/** value to compare against, in the slot of the field's type */
+	union {
+		cots_px_t px;
+		cots_qx_t qx;
+		float f;
+		double d;
+		cots_tag_t tag;
+	} val;
+};
+
+/* predicate operators */
+#define COTS_OP_LT	'<'
+#define COTS_OP_LE	'l'
+#define COTS_OP_GT	'>'
+#define COTS_OP_GE	'g'
+#define COTS_OP_EQ	'='
+
+/**
+ * Like `cots_read_ticks()' but output only ticks satisfying all
+ * NP predicates P, pages whose zone maps rule out any match are
+ * skipped without decoding.
+ * Predicates apply to price, quantity, float, double and tag fields,
+ * which must be projected in TGT.
+ * Return the number of matching ticks, 0 when the series is exhausted,
+ * or -1 if a predicate is malformed. */
+extern ssize_t
+cots_read_filt(struct cots_tsoa_s *restrict tgt, cots_ts_t,
+	       const struct cots_pred_s *p, size_t np);
+
+/**
+ * Follow the file of a read-only series while it's being written to.
+ * `cots_read_ticks()' will then pick up pages flushed by the writer
+ * as well as ticks still in the writer's WAL, and return 0 only when
+ * there is nothing new; call it again later to see more ticks. */
+extern int cots_follow(cots_ts_t);
+
+/**
+ * Keep decoded pages in a cache shared by all series of the process,
+ * using at most BUDGET octets.  Pages are looked up by file and offset,
+ * so series opened on the same file share them.
+ * A BUDGET of 0, the default, turns the cache off. */
+extern int cots_page_cache(size_t budget);
+
+/**
+ * Keep statistics of the series if ON is non-0, or stop keeping them.
+ * Statistics cost a couple of clock readings and atomic updates per
+ * page written or decoded, series keep none unless asked to.
+ * Switching them on afresh starts counting at 0.
+ * Don't switch while other threads read the series. */
+extern int cots_stats_enable(cots_ts_t, int on);
+
+/**
+ * Fill in statistics of series in TGT.
+ * Figures are updated as pages land, possibly by another thread, so
+ * figures of a page that lands meanwhile may be partially included.
+ * Return -1 if statistics aren't kept, see `cots_stats_enable()'. */
+extern int cots_stats(cots_ts_t, struct cots_stats_s *tgt);
+
+/**
+ * Have a worker thread decode up to NPAGES pages ahead of the reader.
+ * Pages are then handed out by `cots_read_ticks()' and `cots_read_range()',
+ * after a `cots_seek()' the worker is repositioned on the next read.
+ * All columns are decoded ahead, projections are applied on hand-out.
+ * Use NPAGES of 0 to stop the worker, detaching a series stops it too. */
+extern int cots_prefetch(cots_ts_t, size_t npages);
+
+/**
+ * Read pages through an io_uring ring, keeping up to DEPTH page reads
+ * in flight ahead of the reader, into buffers registered with the
+ * kernel where possible.  Pages are taken from the page directory,
+ * those written after this call are read the usual way, as are all
+ * pages when `cots_prefetch()' is in effect.
+ * Use DEPTH of 0 to tear the ring down, detaching a series does too.
+ * Return -1 if io_uring isn't available. */
+extern int cots_uring(cots_ts_t, size_t depth);
+
+/**
+ * Callback for `cots_scan_parallel()', NT ticks of page number SEQ
+ * are in TSOA.  Return non-0 to stop the scan. */
+typedef int(*cots_scan_f)(
+	const struct cots_tsoa_s *tsoa, size_t nt, size_t seq, void *clo);
+
+/**
+ * Decode all pages of the series on NTHREADS worker threads and pass
+ * each page to CB along with CLO.
+ * CB is called concurrently and in no particular order, page numbers
+ * allow to reassemble the series.  Unflushed ticks are passed last,
+ * as page number one past the last page.
+ * With NTHREADS of 0 one worker per online CPU is used.
+ * Once CB returns non-0 no further pages are handed out, pages being
+ * passed to CB by other workers at the time still are.
+ * Return the number of ticks in the pages CB accepted, i.e. returned 0
+ * for, or -1 on error. */
+extern ssize_t
+cots_scan_parallel(cots_ts_t, size_t nthreads, cots_scan_f cb, void *clo);
+
+/* Arrow C data interface, cf. arrow.apache.org */
+struct ArrowArray;
+struct ArrowSchema;
+
+/**
+ * Export the first N ticks in TSOA, as read from TS, to ARR and SCH.
+ * The batch becomes a struct array of the time offsets (timestamp[ns])
+ * and the projected columns, all sharing TSOA's buffers, so TSOA must
+ * outlive the exported array and mustn't be read into meanwhile.
+ * Prices and quantities are exported as their raw BID words, of
+ * extension types cots.bid32 and cots.bid64, tags as dictionary-encoded
+ * strings of the series' tags, the empty string standing for no tag.
+ * Return 0 on success, -1 otherwise. */
+extern int
+cots_export_arrow(
+	cots_ts_t, const struct cots_tsoa_s *tsoa, size_t n,
+	struct ArrowArray *arr, struct ArrowSchema *sch);
+
+/**
+ * Cursor merging several series by time. */
+typedef struct cots_mrg_s *cots_mrg_t;
+
+/**
+ * Create a cursor merging the N series TS by time.
+ * All series must have the same layout, each one is read from its
+ * current position onwards (cf. `cots_seek()') and must stay open
+ * for the lifetime of the cursor.
+ * Return NULL on error. */
+extern cots_mrg_t make_cots_mrg(cots_ts_t const *ts, size_t n);
+
+/**
+ * Free a merge cursor, the series remain open. */
+extern void free_cots_mrg(cots_mrg_t);
+
+/**
+ * Read ticks of the merged series in time order, output to TGT.
+ * Ticks of equal time offsets are output in the order of their series.
+ * If SRC is non-NULL it receives for each tick the index of its series.
+ * TGT must be initialised using `cots_init_tsoa()' or
+ * `cots_init_tsoa_proj()' with the first series before the first call,
+ * columns not projected in TGT are not decoded in any of the series.
+ * Return the number of ticks, 0 when all series are exhausted. */
+extern ssize_t
+cots_read_mrg(
+	struct cots_tsoa_s *restrict tgt, size_t *restrict src, cots_mrg_t);
+
 
 /* not so public stuff */
 /* Half-way detach. */
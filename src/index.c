@@ -36,7 +36,7 @@
  ***/
 /**
  * Indices for cotse files are actually just timeseries themselves,
- * with a particular layout "(t)zz" */
+ * with a particular layout "(t)cz" plus zone maps */
 #if defined HAVE_CONFIG_H
 # include "config.h"
 #endif	/* HAVE_CONFIG_H */
@@ -56,14 +56,36 @@ struct idxt_s {
 };
 
 
+size_t
+cots_idx_layo(char *restrict tgt, const char *layo)
+{
+	size_t n = 0U;
+
+	tgt[n++] = COTS_LO_CNT;
+	tgt[n++] = COTS_LO_SIZ;
+	for (; *layo; layo++) {
+		const char zlo = cots_zone_lo(*layo);
+
+		if (zlo) {
+			/* min and max */
+			tgt[n++] = zlo;
+			tgt[n++] = zlo;
+		}
+	}
+	tgt[n] = '\0';
+	return n;
+}
+
 cots_idx_t
-make_cots_idx(const char *filename)
+make_cots_idx(const char *filename, const char *layo)
 {
+	char ilayo[2U * strlen(layo) + 3U];
 	cots_ts_t res;
 
 	if (UNLIKELY(filename == NULL)) {
 		goto nul_out;
 	}
+	cots_idx_layo(ilayo, layo);
 	/* construct temp filename */
 	with (size_t z = strlen(filename)) {
 		char idxfn[z + 5U];
@@ -77,7 +99,7 @@ make_cots_idx(const char *filename)
 			res = cots_open_ts(idxfn, O_RDWR);
 		} else if (UNLIKELY(errno != ENOENT)) {
 			goto nul_out;
-		} else if (UNLIKELY((res = make_cots_ts("cz", 512U)) == NULL)) {
+		} else if (UNLIKELY((res = make_cots_ts(ilayo, 512U)) == NULL)) {
 			goto nul_out;
 		} else if (UNLIKELY(cots_attach(res, idxfn, idxfl) < 0)) {
 			goto fre_out;
@@ -105,13 +127,23 @@ free_cots_idx(cots_idx_t s)
 }
 
 int
-cots_add_index(cots_idx_t s, struct trng_s tr, struct orng_s or, size_t nt)
+cots_add_index(
+	cots_idx_t s, struct trng_s tr, struct orng_s or, size_t nt,
+	const void *zon, size_t zz)
 {
+	struct {
+		struct idxt_s proto;
+		uint8_t zon[zz];
+	} t;
 	int rc = 0;
 
-	rc += cots_bang_tick(s, &(struct idxt_s){{tr.from}, or.beg, nt}.proto);
+	/* zone maps go with both rows */
+	memcpy(t.zon, zon, zz);
+	t.proto = (struct idxt_s){{tr.from}, or.beg, nt};
+	rc += cots_bang_tick(s, &t.proto.proto);
 	rc += cots_keep_last(s);
-	rc += cots_bang_tick(s, &(struct idxt_s){{tr.till}, or.end, nt}.proto);
+	t.proto = (struct idxt_s){{tr.till}, or.end, nt};
+	rc += cots_bang_tick(s, &t.proto.proto);
 	return rc;
 }
 
@@ -36,7 +36,7 @@
  ***/
 /**
  * Indices for cotse files are actually just timeseries themselves,
- * with a particular layout "(t)zz" */
+ * with a particular layout "(t)cz" plus zone maps */
 #if !defined INCLUDED_index_h_
 #define INCLUDED_index_h_
 #include "cotse.h"
@@ -54,10 +54,41 @@ struct orng_s {
 };
 
 
-extern cots_idx_t make_cots_idx(const char *fn);
+/**
+ * Return the layout of zone map values of fields of type LO,
+ * or COTS_LO_END if LO does not get a zone map. */
+static inline char
+cots_zone_lo(char lo)
+{
+	switch (lo) {
+	case COTS_LO_PRC:
+	case COTS_LO_QTY:
+	case COTS_LO_FLT:
+	case COTS_LO_DBL:
+		return lo;
+	case COTS_LO_STR:
+		/* tags are just numbers */
+		return COTS_LO_SIZ;
+	default:
+		break;
+	}
+	return COTS_LO_END;
+}
+
+/**
+ * Put the index layout for series of layout LAYO into TGT,
+ * that's "cz" followed by a min/max pair for each zone-mapped field.
+ * TGT must be able to hold 2 * strlen(LAYO) + 3 characters. */
+extern size_t cots_idx_layo(char *restrict tgt, const char *layo);
+
+extern cots_idx_t make_cots_idx(const char *fn, const char *layo);
 extern void free_cots_idx(cots_idx_t);
 
+/**
+ * Add page at OR holding NT ticks within TR to the index.
+ * Zone map values ZON, laid out as in the index, span ZZ octets. */
 extern int
-cots_add_index(cots_idx_t, struct trng_s, struct orng_s, size_t nt);
+cots_add_index(cots_idx_t, struct trng_s, struct orng_s, size_t nt,
+	       const void *zon, size_t zz);
 
 #endif	/* INCLUDED_index_h_ */
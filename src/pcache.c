@@ -0,0 +1,441 @@
+/*** pcache.c -- process-wide cache of decoded pages
+ *
+ * Copyright (C) 2014-2016 Sebastian Freundt
+ *
+ * Author:  Sebastian Freundt <freundt@ga-group.nl>
+ *
+ * This file is part of cotse.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the author nor the names of any contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+#if defined HAVE_CONFIG_H
+# include "config.h"
+#endif	/* HAVE_CONFIG_H */
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "pcache.h"
+#include "hash.h"
+#include "nifty.h"
+
+/* minimum number of hash buckets */
+#define NBKT_MIN	(64U)
+/* number of file buckets, a power of 2 */
+#define NFBKT		(64U)
+
+/* files with cached pages */
+struct pfil_s {
+	dev_t dev;
+	ino_t ino;
+	/* hash chain */
+	struct pfil_s *next;
+	/* pages of this file */
+	struct pent_s *ents;
+	/* all pages cached start before HI */
+	off_t hi;
+};
+
+struct pent_s {
+	struct pkey_s key;
+	cots_hx_t hx;
+	/* hash chain */
+	struct pent_s *next;
+	/* pages of the same file */
+	struct pfil_s *fil;
+	struct pent_s *fnext;
+	struct pent_s **fprev;
+	/* lru list, towards the most and the least recently used */
+	struct pent_s *mru;
+	struct pent_s *lru;
+	/* columns held, bit i for field i, fields beyond the 64th
+	 * are always held */
+	uint64_t proj;
+	size_t nflds;
+	size_t nt;
+	size_t z;
+	/* time offsets, then the columns held */
+	uint8_t data[];
+};
+
+static struct {
+	pthread_mutex_t mtx;
+	size_t budget;
+	size_t used;
+	/* hash buckets, NBKT is a power of 2 */
+	size_t nbkt;
+	size_t nent;
+	struct pent_s **bkt;
+	/* lru list ends */
+	struct pent_s *head;
+	struct pent_s *tail;
+	/* files by dev/ino */
+	struct pfil_s *fil[NFBKT];
+} pc = {.mtx = PTHREAD_MUTEX_INITIALIZER};
+
+
+static inline cots_hx_t
+_hash_key(struct pkey_s k)
+{
+	const uint64_t v[] = {k.dev, k.ino, k.off};
+	cots_hx_t hx = hash(v, sizeof(v));
+	/* 0 is never a hash */
+	return hx ?: 1U;
+}
+
+static inline size_t
+_fbkt(dev_t dev, ino_t ino)
+{
+	const uint64_t v[] = {dev, ino};
+	return hash(v, sizeof(v)) & (NFBKT - 1U);
+}
+
+static inline int
+_eq_key(struct pkey_s k1, struct pkey_s k2)
+{
+	return k1.dev == k2.dev && k1.ino == k2.ino &&
+		k1.off == k2.off && k1.zn == k2.zn;
+}
+
+static uint64_t
+_proj(const struct cots_tsoa_s *t, size_t nflds)
+{
+	uint64_t p = 0U;
+
+	for (size_t i = 0U; i < nflds && i < 64U; i++) {
+		p |= (uint64_t)(t->cols[i] != NULL) << i;
+	}
+	return p;
+}
+
+static void
+_unlink_lru(struct pent_s *e)
+{
+	if (e->mru) {
+		e->mru->lru = e->lru;
+	} else {
+		pc.head = e->lru;
+	}
+	if (e->lru) {
+		e->lru->mru = e->mru;
+	} else {
+		pc.tail = e->mru;
+	}
+	e->mru = e->lru = NULL;
+	return;
+}
+
+static void
+_push_lru(struct pent_s *e)
+{
+	e->mru = NULL;
+	e->lru = pc.head;
+	if (pc.head) {
+		pc.head->mru = e;
+	} else {
+		pc.tail = e;
+	}
+	pc.head = e;
+	return;
+}
+
+static struct pfil_s**
+_find_fil(dev_t dev, ino_t ino)
+{
+/* return the slot pointing to file DEV/INO, or to NULL if not present */
+	struct pfil_s **fp = pc.fil + _fbkt(dev, ino);
+
+	for (; *fp; fp = &(*fp)->next) {
+		if ((*fp)->dev == dev && (*fp)->ino == ino) {
+			break;
+		}
+	}
+	return fp;
+}
+
+static int
+_link_fil(struct pent_s *e)
+{
+	struct pfil_s **fp = _find_fil(e->key.dev, e->key.ino);
+	struct pfil_s *f = *fp;
+
+	if (f == NULL) {
+		if (UNLIKELY((f = malloc(sizeof(*f))) == NULL)) {
+			return -1;
+		}
+		*f = (struct pfil_s){.dev = e->key.dev, .ino = e->key.ino};
+		*fp = f;
+	}
+	e->fil = f;
+	e->fnext = f->ents;
+	e->fprev = &f->ents;
+	if (f->ents) {
+		f->ents->fprev = &e->fnext;
+	}
+	f->ents = e;
+	if (e->key.off >= f->hi) {
+		f->hi = e->key.off + 1;
+	}
+	return 0;
+}
+
+static void
+_unlink_fil(struct pent_s *e)
+{
+	struct pfil_s *f = e->fil;
+
+	*e->fprev = e->fnext;
+	if (e->fnext) {
+		e->fnext->fprev = e->fprev;
+	}
+	if (f->ents == NULL) {
+		/* last page of this file */
+		struct pfil_s **fp = _find_fil(f->dev, f->ino);
+
+		*fp = f->next;
+		free(f);
+	}
+	return;
+}
+
+static void
+_kill(struct pent_s *e)
+{
+/* remove E from the hash table and the lru list and free it */
+	for (struct pent_s **ep = pc.bkt + (e->hx & (pc.nbkt - 1U));
+	     *ep; ep = &(*ep)->next) {
+		if (*ep == e) {
+			*ep = e->next;
+			break;
+		}
+	}
+	_unlink_lru(e);
+	_unlink_fil(e);
+	pc.used -= e->z;
+	pc.nent--;
+	free(e);
+	return;
+}
+
+static void
+_evict(size_t z)
+{
+/* evict least recently used pages until Z octets fit into the budget */
+	while (pc.tail && pc.used + z > pc.budget) {
+		_kill(pc.tail);
+	}
+	return;
+}
+
+static int
+_resz(void)
+{
+	const size_t nuz = pc.nbkt ? pc.nbkt * 2U : NBKT_MIN;
+	struct pent_s **nu = calloc(nuz, sizeof(*nu));
+
+	if (UNLIKELY(nu == NULL)) {
+		return -1;
+	}
+	/* rehash */
+	for (size_t i = 0U; i < pc.nbkt; i++) {
+		for (struct pent_s *e = pc.bkt[i], *next; e; e = next) {
+			const size_t j = e->hx & (nuz - 1U);
+
+			next = e->next;
+			e->next = nu[j];
+			nu[j] = e;
+		}
+	}
+	free(pc.bkt);
+	pc.bkt = nu;
+	pc.nbkt = nuz;
+	return 0;
+}
+
+static struct pent_s*
+_find(struct pkey_s k, cots_hx_t hx)
+{
+	if (UNLIKELY(!pc.nbkt)) {
+		return NULL;
+	}
+	for (struct pent_s *e = pc.bkt[hx & (pc.nbkt - 1U)]; e; e = e->next) {
+		if (e->hx == hx && _eq_key(e->key, k)) {
+			return e;
+		}
+	}
+	return NULL;
+}
+
+
+/* public api */
+void
+pcache_budget(size_t z)
+{
+	pthread_mutex_lock(&pc.mtx);
+	__atomic_store_n(&pc.budget, z, __ATOMIC_RELAXED);
+	_evict(0U);
+	if (!z && pc.bkt) {
+		free(pc.bkt);
+		pc.bkt = NULL;
+		pc.nbkt = 0U;
+	}
+	pthread_mutex_unlock(&pc.mtx);
+	return;
+}
+
+ssize_t
+pcache_get(struct cots_tsoa_s *restrict tgt, struct pkey_s key,
+	   const size_t *wid, size_t nflds)
+{
+	const uint64_t proj = _proj(tgt, nflds);
+	const cots_hx_t hx = _hash_key(key);
+	struct pent_s *e;
+	ssize_t nt = -1;
+
+	if (!__atomic_load_n(&pc.budget, __ATOMIC_RELAXED)) {
+		return -1;
+	}
+	pthread_mutex_lock(&pc.mtx);
+	if ((e = _find(key, hx)) == NULL) {
+		goto out;
+	} else if (e->nflds != nflds || (proj & ~e->proj)) {
+		/* not what we need */
+		goto out;
+	}
+	/* copy out */
+	with (const uint8_t *dp = e->data) {
+		memcpy(tgt->toffs, dp, e->nt * sizeof(*tgt->toffs));
+		dp += e->nt * sizeof(*tgt->toffs);
+		for (size_t i = 0U; i < nflds; i++) {
+			if (i < 64U && !((e->proj >> i) & 0b1U)) {
+				continue;
+			} else if (tgt->cols[i] != NULL) {
+				memcpy(tgt->cols[i], dp, e->nt * wid[i]);
+			}
+			dp += e->nt * wid[i];
+		}
+	}
+	nt = e->nt;
+	/* make him most recently used */
+	_unlink_lru(e);
+	_push_lru(e);
+out:
+	pthread_mutex_unlock(&pc.mtx);
+	return nt;
+}
+
+void
+pcache_put(struct pkey_s key, const struct cots_tsoa_s *src, size_t nt,
+	   const size_t *wid, size_t nflds)
+{
+	const uint64_t proj = _proj(src, nflds);
+	const cots_hx_t hx = _hash_key(key);
+	size_t z = nt * sizeof(*src->toffs);
+	struct pent_s *e;
+
+	if (!__atomic_load_n(&pc.budget, __ATOMIC_RELAXED)) {
+		return;
+	}
+	for (size_t i = 0U; i < nflds; i++) {
+		z += src->cols[i] != NULL ? nt * wid[i] : 0U;
+	}
+	if (UNLIKELY((e = malloc(sizeof(*e) + z)) == NULL)) {
+		return;
+	}
+	*e = (struct pent_s){key, hx, .proj = proj,
+			     .nflds = nflds, .nt = nt, .z = sizeof(*e) + z};
+	with (uint8_t *dp = e->data) {
+		memcpy(dp, src->toffs, nt * sizeof(*src->toffs));
+		dp += nt * sizeof(*src->toffs);
+		for (size_t i = 0U; i < nflds; i++) {
+			if (src->cols[i] == NULL) {
+				continue;
+			}
+			memcpy(dp, src->cols[i], nt * wid[i]);
+			dp += nt * wid[i];
+		}
+	}
+
+	pthread_mutex_lock(&pc.mtx);
+	with (struct pent_s *old = _find(key, hx)) {
+		if (old != NULL) {
+			/* replace, assume the newer one is better */
+			_kill(old);
+		}
+	}
+	if (UNLIKELY(e->z > pc.budget)) {
+		/* won't ever fit */
+		free(e);
+		goto out;
+	}
+	_evict(e->z);
+	if (pc.nent >= pc.nbkt && UNLIKELY(_resz() < 0)) {
+		free(e);
+		goto out;
+	} else if (UNLIKELY(_link_fil(e) < 0)) {
+		free(e);
+		goto out;
+	}
+	with (size_t j = hx & (pc.nbkt - 1U)) {
+		e->next = pc.bkt[j];
+		pc.bkt[j] = e;
+	}
+	_push_lru(e);
+	pc.used += e->z;
+	pc.nent++;
+out:
+	pthread_mutex_unlock(&pc.mtx);
+	return;
+}
+
+void
+pcache_drop(dev_t dev, ino_t ino, off_t off)
+{
+	if (!__atomic_load_n(&pc.budget, __ATOMIC_RELAXED)) {
+		return;
+	}
+	pthread_mutex_lock(&pc.mtx);
+	with (struct pfil_s *f = *_find_fil(dev, ino)) {
+		if (f == NULL || off >= f->hi) {
+			/* appending writers end up here */
+			break;
+		}
+		/* lower HI first, the file may go away under us */
+		f->hi = off;
+		for (struct pent_s *e = f->ents, *fnext; e; e = fnext) {
+			fnext = e->fnext;
+			if (e->key.off >= off) {
+				_kill(e);
+			}
+		}
+	}
+	pthread_mutex_unlock(&pc.mtx);
+	return;
+}
+
+/* pcache.c ends here */
@@ -0,0 +1,78 @@
+/*** pcache.h -- process-wide cache of decoded pages
+ *
+ * Copyright (C) 2014-2016 Sebastian Freundt
+ *
+ * Author:  Sebastian Freundt <freundt@ga-group.nl>
+ *
+ * This file is part of cotse.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the author nor the names of any contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+#if !defined INCLUDED_pcache_h_
+#define INCLUDED_pcache_h_
+#include <stdint.h>
+#include <sys/types.h>
+#include "cotse.h"
+
+/**
+ * Pages are identified by their file and offset, the page's size word
+ * is kept alongside to tell rewritten pages apart. */
+struct pkey_s {
+	dev_t dev;
+	ino_t ino;
+	off_t off;
+	uint64_t zn;
+};
+
+/**
+ * Set the cache budget to Z octets, evicting pages as necessary.
+ * A budget of 0 disables the cache. */
+extern void pcache_budget(size_t z);
+
+/**
+ * Copy the columns projected in TGT of page KEY to TGT.
+ * WID holds the widths of the NFLDS fields.
+ * Return the number of ticks or -1 if no such page is cached
+ * or if the cached version lacks some of the columns. */
+extern ssize_t
+pcache_get(struct cots_tsoa_s *restrict tgt, struct pkey_s key,
+	   const size_t *wid, size_t nflds);
+
+/**
+ * Cache the columns projected in SRC of page KEY holding NT ticks.
+ * WID holds the widths of the NFLDS fields. */
+extern void
+pcache_put(struct pkey_s key, const struct cots_tsoa_s *src, size_t nt,
+	   const size_t *wid, size_t nflds);
+
+/**
+ * Forget all pages of file DEV/INO at or beyond offset OFF. */
+extern void pcache_drop(dev_t dev, ino_t ino, off_t off);
+
+#endif	/* INCLUDED_pcache_h_ */
@@ -36,25 +36,24 @@
 #endif	/* __INTEL_COMPILER */
 
 #define PAD8(__x)	(((__x) + 8 - 1) / 8)
-#define P4DSIZE		(128U)
 #define P4DN		(P4DSIZE / 64U)
 
 static inline unsigned int
 bsr16(uint16_t x)
 {
-	return (1U + (15U ^ (__builtin_clz(x) - 16U))) & 31U;
+	return x ? 1U + (15U ^ (__builtin_clz(x) - 16U)) : 0U;
 }
 
 static inline unsigned int
 bsr32(uint32_t x)
 {
-	return (1U + (31U ^ __builtin_clz(x))) & 63U;
+	return x ? 1U + (31U ^ __builtin_clz(x)) : 0U;
 }
 
 static inline unsigned int
 bsr64(uint64_t x)
 {
-	return (1U + (63U ^ __builtin_clzl(x))) & 127U;
+	return x ? 1U + (63U ^ __builtin_clzl(x)) : 0U;
 }
 
 #if defined __INTEL_COMPILER && defined __SSE4_2__
@@ -141,6 +140,38 @@ static ALIGNED(char, shuffles[16][16], 16) = {
 #include __FILE__
 #undef USIZE
 
+
+size_t
+pfor_skip(const uint8_t *restrict in, size_t n)
+{
+/* block headers are the same for all widths, walk them */
+	const uint8_t *const oin = in;
+
+	for (size_t i = 0U; i < n; i += P4DSIZE) {
+		const size_t nt = P4DSIZE < n - i ? P4DSIZE : n - i;
+		unsigned int b = *in++, bx = 0U;
+
+		if (b & 0b1U) {
+			bx = *in++;
+		}
+		in += PAD8(nt * (b >> 1U));
+
+		if (b & 0b1U) {
+			unsigned int num = 0U;
+
+			for (size_t j = 0U; j < P4DN; j++) {
+				uint64_t x;
+
+				memcpy(&x, in + j * sizeof(x), sizeof(x));
+				num += xpopcnt64(x);
+			}
+			in += P4DN * sizeof(uint64_t);
+			in += PAD8(num * bx);
+		}
+	}
+	return in - oin;
+}
+
 #else
 
 #define uint_t paste(paste(uint, USIZE), _t)
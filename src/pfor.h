@@ -26,6 +26,9 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+/* values are packed in independent blocks of this many */
+#define P4DSIZE		(128U)
+
 // compress integer array with n values to the buffer out. Return value = end of compressed buffer out
 extern size_t
 pfor_enc16(uint8_t *restrict out, const uint16_t *restrict in, size_t n);
@@ -42,4 +45,8 @@ pfor_dec32(uint32_t *restrict out, const uint8_t *restrict in, size_t n);
 extern size_t
 pfor_dec64(uint64_t *restrict out, const uint8_t *restrict in, size_t n);
 
+// return the size of the first n values packed in the buffer in, without unpacking them
+extern size_t
+pfor_skip(const uint8_t *restrict in, size_t n);
+
 #endif	/* INCLUDED_pfor_h_ */
@@ -0,0 +1,345 @@
+/*** uring.c -- asynchronous reads through io_uring
+ *
+ * Copyright (C) 2014-2016 Sebastian Freundt
+ *
+ * Author:  Sebastian Freundt <freundt@ga-group.nl>
+ *
+ * This file is part of cotse.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the author nor the names of any contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+#if defined HAVE_CONFIG_H
+# include "config.h"
+#endif	/* HAVE_CONFIG_H */
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#if defined HAVE_LINUX_IO_URING_H
+# include <linux/io_uring.h>
+#endif	/* HAVE_LINUX_IO_URING_H */
+#include "uring.h"
+#include "nifty.h"
+
+#if defined HAVE_LINUX_IO_URING_H && defined __NR_io_uring_setup
+struct uring_s {
+	int fd;
+	int rfd;
+	/* whether buffers are registered */
+	int fixed;
+	/* number of reads in flight */
+	size_t nfl;
+	/* reads queued but not yet submitted */
+	unsigned int nq;
+
+	/* submission ring */
+	void *sqp;
+	size_t sqz;
+	unsigned int *sqh;
+	unsigned int *sqt;
+	unsigned int sqm;
+	unsigned int *sqa;
+	struct io_uring_sqe *sqe;
+	size_t sqez;
+
+	/* completion ring, may share the mapping with the submission ring */
+	void *cqp;
+	size_t cqz;
+	unsigned int *cqh;
+	unsigned int *cqt;
+	unsigned int cqm;
+	struct io_uring_cqe *cqe;
+
+	size_t nbuf;
+	size_t bufz;
+	uint8_t *buf;
+};
+
+
+static int
+_setup(unsigned int n, struct io_uring_params *p)
+{
+	return syscall(__NR_io_uring_setup, n, p);
+}
+
+static int
+_enter(int rfd, unsigned int nsub, unsigned int nmin, unsigned int fl)
+{
+	return syscall(__NR_io_uring_enter, rfd, nsub, nmin, fl, NULL, 0);
+}
+
+static int
+_register(int rfd, unsigned int op, const void *arg, unsigned int n)
+{
+	return syscall(__NR_io_uring_register, rfd, op, arg, n);
+}
+
+
+uring_t
+make_uring(int fd, size_t nbuf, size_t bufz)
+{
+	struct io_uring_params p = {0U};
+	struct uring_s *r;
+	uint8_t *sq, *cq;
+
+	if (UNLIKELY(!nbuf || !bufz)) {
+		return NULL;
+	} else if (UNLIKELY((r = calloc(1U, sizeof(*r))) == NULL)) {
+		return NULL;
+	}
+	r->fd = fd;
+	r->rfd = -1;
+	r->sqp = r->cqp = MAP_FAILED;
+	r->sqe = MAP_FAILED;
+	r->buf = MAP_FAILED;
+	if (UNLIKELY((r->rfd = _setup(nbuf, &p)) < 0)) {
+		goto err;
+	}
+
+	/* map the rings */
+	r->sqz = p.sq_off.array + p.sq_entries * sizeof(unsigned int);
+	r->cqz = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+	if (p.features & IORING_FEAT_SINGLE_MMAP) {
+		r->sqz = r->cqz = r->sqz > r->cqz ? r->sqz : r->cqz;
+	}
+	r->sqp = mmap(NULL, r->sqz, PROT_READ | PROT_WRITE,
+		      MAP_SHARED | MAP_POPULATE, r->rfd, IORING_OFF_SQ_RING);
+	if (UNLIKELY(r->sqp == MAP_FAILED)) {
+		goto err;
+	} else if (p.features & IORING_FEAT_SINGLE_MMAP) {
+		r->cqp = r->sqp;
+	} else {
+		r->cqp = mmap(NULL, r->cqz, PROT_READ | PROT_WRITE,
+			      MAP_SHARED | MAP_POPULATE, r->rfd,
+			      IORING_OFF_CQ_RING);
+		if (UNLIKELY(r->cqp == MAP_FAILED)) {
+			goto err;
+		}
+	}
+	r->sqez = p.sq_entries * sizeof(struct io_uring_sqe);
+	r->sqe = mmap(NULL, r->sqez, PROT_READ | PROT_WRITE,
+		      MAP_SHARED | MAP_POPULATE, r->rfd, IORING_OFF_SQES);
+	if (UNLIKELY(r->sqe == MAP_FAILED)) {
+		goto err;
+	}
+	sq = r->sqp;
+	r->sqh = (void*)(sq + p.sq_off.head);
+	r->sqt = (void*)(sq + p.sq_off.tail);
+	r->sqm = *(unsigned int*)(sq + p.sq_off.ring_mask);
+	r->sqa = (void*)(sq + p.sq_off.array);
+	cq = r->cqp;
+	r->cqh = (void*)(cq + p.cq_off.head);
+	r->cqt = (void*)(cq + p.cq_off.tail);
+	r->cqm = *(unsigned int*)(cq + p.cq_off.ring_mask);
+	r->cqe = (void*)(cq + p.cq_off.cqes);
+
+	/* buffers, page-aligned */
+	r->nbuf = nbuf;
+	r->bufz = bufz;
+	r->buf = mmap(NULL, nbuf * bufz, PROT_READ | PROT_WRITE,
+		      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (UNLIKELY(r->buf == MAP_FAILED)) {
+		goto err;
+	}
+	with (struct iovec iov[nbuf]) {
+		for (size_t i = 0U; i < nbuf; i++) {
+			iov[i] = (struct iovec){r->buf + i * bufz, bufz};
+		}
+		/* don't worry if we can't pin them, plain reads will do */
+		r->fixed = !(_register(
+				     r->rfd, IORING_REGISTER_BUFFERS,
+				     iov, nbuf) < 0);
+	}
+	return r;
+
+err:
+	free_uring(r);
+	return NULL;
+}
+
+void
+free_uring(uring_t r)
+{
+	/* reads in flight still write to our buffers */
+	while (r->nfl) {
+		const size_t nfl = r->nfl;
+		size_t i;
+
+		(void)uring_wait(r, &i);
+		if (UNLIKELY(r->nfl >= nfl)) {
+			/* ring's broken, better leak than be written to */
+			return;
+		}
+	}
+
+	if (r->buf != MAP_FAILED) {
+		munmap(r->buf, r->nbuf * r->bufz);
+	}
+	if (r->sqe != MAP_FAILED) {
+		munmap(r->sqe, r->sqez);
+	}
+	if (r->cqp != MAP_FAILED && r->cqp != r->sqp) {
+		munmap(r->cqp, r->cqz);
+	}
+	if (r->sqp != MAP_FAILED) {
+		munmap(r->sqp, r->sqz);
+	}
+	if (r->rfd >= 0) {
+		close(r->rfd);
+	}
+	free(r);
+	return;
+}
+
+uint8_t*
+uring_buf(uring_t r, size_t i)
+{
+	return r->buf + i * r->bufz;
+}
+
+int
+uring_read(uring_t r, size_t i, off_t o, size_t z)
+{
+	const unsigned int t = *r->sqt;
+	struct io_uring_sqe *sqe;
+
+	if (UNLIKELY(i >= r->nbuf || z > r->bufz)) {
+		return -1;
+	} else if (UNLIKELY(t - __atomic_load_n(r->sqh, __ATOMIC_ACQUIRE) >
+			    r->sqm)) {
+		/* submission ring's full */
+		return -1;
+	}
+	sqe = r->sqe + (t & r->sqm);
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = r->fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+	sqe->fd = r->fd;
+	sqe->off = o;
+	sqe->addr = (uintptr_t)(r->buf + i * r->bufz);
+	sqe->len = z;
+	sqe->buf_index = i;
+	sqe->user_data = i;
+	r->sqa[t & r->sqm] = t & r->sqm;
+	__atomic_store_n(r->sqt, t + 1U, __ATOMIC_RELEASE);
+	r->nq++;
+	return 0;
+}
+
+ssize_t
+uring_submit(uring_t r)
+{
+	const unsigned int t = *r->sqt;
+	unsigned int h;
+	ssize_t n;
+
+	if (!r->nq) {
+		return 0;
+	}
+	while (_enter(r->rfd, r->nq, 0U, 0U) < 0) {
+		if (errno != EINTR && errno != EAGAIN) {
+			break;
+		}
+	}
+	/* without SQ polling the kernel only consumes entries in _enter(),
+	 * in order, so entries past the head are still ours */
+	h = __atomic_load_n(r->sqh, __ATOMIC_ACQUIRE);
+	if (UNLIKELY(h != t)) {
+		/* take them back, lest the next submission reads them too */
+		__atomic_store_n(r->sqt, h, __ATOMIC_RELEASE);
+	}
+	n = r->nq - (t - h);
+	r->nq = 0U;
+	r->nfl += n;
+	return n ?: -1;
+}
+
+ssize_t
+uring_wait(uring_t r, size_t *i)
+{
+	const unsigned int h = *r->cqh;
+	const struct io_uring_cqe *cqe;
+	ssize_t res;
+
+	while (h == __atomic_load_n(r->cqt, __ATOMIC_ACQUIRE)) {
+		if (_enter(r->rfd, 0U, 1U, IORING_ENTER_GETEVENTS) < 0 &&
+		    errno != EINTR && errno != EAGAIN) {
+			return -1;
+		}
+	}
+	cqe = r->cqe + (h & r->cqm);
+	*i = cqe->user_data;
+	res = cqe->res;
+	__atomic_store_n(r->cqh, h + 1U, __ATOMIC_RELEASE);
+	r->nfl--;
+	return res < 0 ? -1 : res;
+}
+
+#else  /* !HAVE_LINUX_IO_URING_H */
+uring_t
+make_uring(int UNUSED(fd), size_t UNUSED(nbuf), size_t UNUSED(bufz))
+{
+	return NULL;
+}
+
+void
+free_uring(uring_t UNUSED(r))
+{
+	return;
+}
+
+uint8_t*
+uring_buf(uring_t UNUSED(r), size_t UNUSED(i))
+{
+	return NULL;
+}
+
+int
+uring_read(uring_t UNUSED(r), size_t UNUSED(i),
+	   off_t UNUSED(o), size_t UNUSED(z))
+{
+	return -1;
+}
+
+ssize_t
+uring_submit(uring_t UNUSED(r))
+{
+	return -1;
+}
+
+ssize_t
+uring_wait(uring_t UNUSED(r), size_t *UNUSED(i))
+{
+	return -1;
+}
+#endif	/* HAVE_LINUX_IO_URING_H */
+
+/* uring.c ends here */
@@ -0,0 +1,80 @@
+/*** uring.h -- asynchronous reads through io_uring
+ *
+ * Copyright (C) 2014-2016 Sebastian Freundt
+ *
+ * Author:  Sebastian Freundt <freundt@ga-group.nl>
+ *
+ * This file is part of cotse.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the author nor the names of any contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***/
+#if !defined INCLUDED_uring_h_
+#define INCLUDED_uring_h_
+#include <stdint.h>
+#include <sys/types.h>
+
+/**
+ * Submission/completion ring for reads of one file into a fixed set
+ * of equally sized buffers. */
+typedef struct uring_s *uring_t;
+
+/**
+ * Set up a ring reading from FD into NBUF buffers of BUFZ octets each.
+ * Buffers are registered with the kernel if possible.
+ * Return NULL if io_uring isn't available. */
+extern uring_t make_uring(int fd, size_t nbuf, size_t bufz);
+
+/**
+ * Free ring R, reads still in flight are waited for. */
+extern void free_uring(uring_t r);
+
+/**
+ * Return the buffer of slot I. */
+extern uint8_t *uring_buf(uring_t r, size_t i);
+
+/**
+ * Queue a read of Z octets at offset O into the buffer of slot I,
+ * to be submitted by `uring_submit()'.
+ * Return 0 on success, -1 if the submission ring is full. */
+extern int uring_read(uring_t r, size_t i, off_t o, size_t z);
+
+/**
+ * Submit all queued reads in one go.
+ * Reads are submitted in the order they were queued, those the kernel
+ * didn't take are dropped.
+ * Return the number of reads submitted, 0 if none were queued,
+ * or -1 if none of them could be submitted. */
+extern ssize_t uring_submit(uring_t r);
+
+/**
+ * Wait for the completion of a read, store its slot in I.
+ * Return the number of octets read or -1 on error. */
+extern ssize_t uring_wait(uring_t r, size_t *i);
+
+#endif	/* INCLUDED_uring_h_ */
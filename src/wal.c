@@ -45,6 +45,7 @@
 #include <stdint.h>
 #include <string.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <fcntl.h>
 #include "cotse.h"
 #include "wal.h"
@@ -67,7 +68,7 @@ _walz(const struct cots_wal_s *w)
 static inline void
 _wal_init(struct cots_wal_s *restrict w, size_t zrow, size_t blkz)
 {
-	struct cots_wal_s proto = {"cots", "w0", COTS_ENDIAN, blkz, zrow};
+	struct cots_wal_s proto = {"cots", "w1", COTS_ENDIAN, blkz, zrow};
 	memcpy(w, &proto, sizeof(proto));
 	return;
 }
@@ -106,13 +107,11 @@ _wal_create(size_t zrow, size_t blkz, const char *fn)
 		goto nul_out;
 	}
 	/* construct temp filename */
-	with (size_t z = strlen(fn)) {
-		char walfn[z + 5U];
+	with (size_t z = WALFN_Z(fn)) {
+		char walfn[z];
 		const int walfl = O_CREAT | O_TRUNC/*?*/ | O_RDWR;
 
-		memcpy(walfn, fn, z);
-		memcpy(walfn + z, ".wal", sizeof(".wal"));
-
+		_wal_fn(walfn, fn);
 		if (UNLIKELY((fd = open(walfn, walfl, 0666)) < 0)) {
 			goto nul_out;
 		}
@@ -147,13 +146,11 @@ _wal_attach(const struct cots_wal_s *w, const char *fn)
 		goto nul_out;
 	}
 	/* construct temp filename */
-	with (size_t z = strlen(fn)) {
-		char walfn[z + 5U];
+	with (size_t z = WALFN_Z(fn)) {
+		char walfn[z];
 		const int walfl = O_CREAT | O_TRUNC/*?*/ | O_RDWR;
 
-		memcpy(walfn, fn, z);
-		memcpy(walfn + z, ".wal", sizeof(".wal"));
-
+		_wal_fn(walfn, fn);
 		if (UNLIKELY((fd = open(walfn, walfl, 0666)) < 0)) {
 			goto nul_out;
 		}
@@ -177,6 +174,57 @@ nul_out:
 	return res;
 }
 
+struct cots_wal_s*
+_wal_snarf(size_t zrow, size_t blkz, const char *fn)
+{
+	const size_t fz = zrow * blkz + sizeof(struct cots_wal_s);
+	struct cots_wal_s *res;
+	struct stat st;
+	ssize_t nrd;
+	int fd;
+
+	if (UNLIKELY(fn == NULL)) {
+		return NULL;
+	}
+	/* construct temp filename */
+	with (size_t z = WALFN_Z(fn)) {
+		char walfn[z];
+
+		_wal_fn(walfn, fn);
+		if ((fd = open(walfn, O_RDONLY)) < 0) {
+			return NULL;
+		}
+	}
+	if (UNLIKELY(fstat(fd, &st) < 0 || st.st_size != (off_t)fz)) {
+		goto clo_out;
+	} else if (UNLIKELY((res = _make_wal(zrow, blkz)) == NULL)) {
+		goto clo_out;
+	}
+	/* read it into memory, the file itself is about to be truncated */
+	nrd = pread(fd, res, fz, 0);
+	close(fd);
+
+	if (UNLIKELY(nrd != (ssize_t)fz)) {
+		goto fre_out;
+	} else if (memcmp(res->magic, "cots", sizeof(res->magic)) ||
+		   memcmp(res->version, "w1", sizeof(res->version))) {
+		goto fre_out;
+	} else if (res->endian != COTS_ENDIAN ||
+		   res->zrow != zrow || res->blkz != blkz) {
+		goto fre_out;
+	} else if (res->rowi > blkz || res->nkeep > res->rowi) {
+		goto fre_out;
+	}
+	return res;
+
+fre_out:
+	_free_wal(res);
+	return NULL;
+clo_out:
+	close(fd);
+	return NULL;
+}
+
 int
 _wal_detach(const struct cots_wal_s *w, const char *fn)
 {
@@ -185,12 +233,10 @@ _wal_detach(const struct cots_wal_s *w, const char *fn)
 	}
 	_free_wal(deconst(w));
 	/* construct temp filename */
-	with (size_t z = strlen(fn)) {
-		char walfn[z + 5U];
-
-		memcpy(walfn, fn, z);
-		memcpy(walfn + z, ".wal", sizeof(".wal"));
+	with (size_t z = WALFN_Z(fn)) {
+		char walfn[z];
 
+		_wal_fn(walfn, fn);
 		unlink(walfn);
 	}
 	return 0;
@@ -45,7 +45,7 @@
 struct cots_wal_s {
 	/* should be "cots" */
 	const uint8_t magic[4U];
-	/* should be "w0" */
+	/* should be "w1" */
 	const uint8_t version[2U];
 	/* COTS_ENDIAN written in native endian */
 	const uint16_t endian;
@@ -55,6 +55,10 @@ struct cots_wal_s {
 	const uint64_t zrow;
 	/* row index in native endian */
 	uint64_t rowi;
+	/* offset in the series file the rows go to, of which the first
+	 * NKEEP are in the file already, for replaying after a crash */
+	uint64_t moff;
+	uint64_t nkeep;
 	/* the ordinary data, aligned on a 16 byte boundary
 	 * written in native endian */
 	uint8_t data[];
@@ -73,7 +77,28 @@ _wal_detach(const struct cots_wal_s *w, const char *fn);
 extern struct cots_wal_s*
 _wal_create(size_t zrow, size_t blkz, const char *fn);
 
+/**
+ * Return a copy of the WAL left behind for series file FN, or NULL if
+ * there is none or it doesn't fit the ZROW and BLKZ geometry. */
+extern struct cots_wal_s*
+_wal_snarf(size_t zrow, size_t blkz, const char *fn);
+
 
+/* room needed for the name of the WAL of series file FN */
+#define WALFN_Z(fn)	(strlen(fn) + sizeof(".wal"))
+
+static inline char*
+_wal_fn(char *restrict buf, const char *fn)
+{
+/* put the name of the WAL of series file FN into BUF,
+ * which must hold WALFN_Z(FN) octets, return BUF */
+	const size_t z = strlen(fn);
+
+	memcpy(buf, fn, z);
+	memcpy(buf + z, ".wal", sizeof(".wal"));
+	return buf;
+}
+
 static inline __attribute__((const)) size_t
 _wal_rowi(const struct cots_wal_s *w)
 {
@@ -89,12 +114,27 @@ _wal_rset(struct cots_wal_s *w, size_t n)
 	return;
 }
 
+static inline void
+_wal_stamp(struct cots_wal_s *w, uint64_t moff, size_t nkeep)
+{
+/* rows go to the series file at MOFF, the first NKEEP are there already */
+	w->moff = moff;
+	w->nkeep = nkeep;
+	return;
+}
+
 static inline size_t
 _wal_rinc(struct cots_wal_s *w)
 {
 	return ++w->rowi;
 }
 
+static inline size_t
+_wal_radd(struct cots_wal_s *w, size_t n)
+{
+	return w->rowi += n;
+}
+
 static inline void
 _wal_bang(struct cots_wal_s *restrict w, const void *data)
 {
@@ -125,4 +165,27 @@ _wal_last(void *restrict data, const struct cots_wal_s *w)
 	return;
 }
 
+static inline void
+_wal_keep(struct cots_wal_s *w)
+{
+/* move the tick before the current row index to the end of the buffer
+ * where it'll be found as last tick once the row index is reset */
+	register const size_t blkz = w->blkz - 1U;
+	register const size_t zrow = w->zrow;
+	register const size_t rowi = (_wal_rowi(w) - 1U) & blkz;
+	memmove(w->data + blkz * zrow, w->data + rowi * zrow, zrow);
+	return;
+}
+
+static inline void
+_wal_copy(struct cots_wal_s *restrict tgt, const struct cots_wal_s *src)
+{
+/* copy rows and row index of SRC to TGT of the same geometry */
+	register const size_t rowi = _wal_rowi(src);
+	register const size_t zrow = src->zrow;
+	memcpy(tgt->data, src->data, rowi * zrow);
+	tgt->rowi = rowi;
+	return;
+}
+
 #endif	/* INCLUDED_wal_h_ */
@@ -0,0 +1,107 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <cotse.h>
+#include "arrow.h"
+
+struct quote {
+	struct cots_tick_s proto;
+	cots_tag_t s;
+	cots_qx_t q;
+	cots_px_t p;
+};
+
+struct quote_soa {
+	struct cots_tsoa_s proto;
+	cots_tag_t *s;
+	cots_qx_t *q;
+	cots_px_t *p;
+};
+
+static void
+prsch(const struct ArrowSchema *sch, const char *ind)
+{
+	printf("%s%s\t%s", ind, sch->name, sch->format);
+	if (sch->metadata != NULL) {
+		int32_t kz, vz;
+
+		memcpy(&kz, sch->metadata + 4U, sizeof(kz));
+		memcpy(&vz, sch->metadata + 8U + kz, sizeof(vz));
+		printf("\t%.*s", (int)vz, sch->metadata + 12U + kz);
+	}
+	putchar('\n');
+	for (int64_t i = 0; i < sch->n_children; i++) {
+		prsch(sch->children[i], "  ");
+	}
+	if (sch->dictionary != NULL) {
+		prsch(sch->dictionary, "  dict ");
+	}
+	return;
+}
+
+int main(void)
+{
+	static const char *flds[] = {"sym", "qty", "prc", NULL};
+	cots_ts_t db = make_cots_ts("sqp", 0U);
+	struct quote_soa c;
+	struct ArrowArray arr;
+	struct ArrowSchema sch;
+	ssize_t n;
+
+	cots_attach(db, "arrow_01.cots", O_CREAT | O_TRUNC | O_RDWR);
+	cots_put_fields(db, flds);
+	for (size_t i = 0U; i < 10U; i++) {
+		static const char *syms[] = {"AAPL", "MSFT", ""};
+		const char *sym = syms[i % 3U];
+		struct quote t = {
+			{i * 1000U}, cots_tag(db, sym, strlen(sym)),
+			(cots_qx_t)i, (cots_px_t)i,
+		};
+		cots_write_tick(db, &t.proto);
+	}
+	cots_detach(db);
+	free_cots_ts(db);
+
+	db = cots_open_ts("arrow_01.cots", O_RDONLY);
+	/* leave out the quantities */
+	cots_init_tsoa_proj(&c.proto, db, 0b101U);
+	n = cots_read_ticks(&c.proto, db);
+	if (cots_export_arrow(db, &c.proto, n, &arr, &sch) < 0) {
+		puts("export failed");
+		return 1;
+	}
+	prsch(&sch, "");
+	printf("%lld\t%lld\n", (long long)arr.length, (long long)arr.n_children);
+	/* buffers are shared */
+	printf("%d %d %d\n",
+	       arr.children[0U]->buffers[1U] == c.proto.toffs,
+	       arr.children[1U]->buffers[1U] == c.s,
+	       arr.children[2U]->buffers[1U] == c.p);
+	{
+		const struct ArrowArray *d = arr.children[1U]->dictionary;
+		const int32_t *off = d->buffers[1U];
+		const char *dat = d->buffers[2U];
+		const int64_t *ix = arr.children[1U]->buffers[1U];
+
+		for (int64_t i = 0; i < arr.length; i++) {
+			printf("%s%.*s", i ? " " : "",
+			       (int)(off[ix[i] + 1] - off[ix[i]]), dat + off[ix[i]]);
+		}
+		putchar('\n');
+	}
+	/* move a child out and release it after its parent */
+	{
+		struct ArrowArray ch = *arr.children[1U];
+
+		arr.children[1U]->release = NULL;
+		arr.release(&arr);
+		ch.release(&ch);
+		printf("%d %d\n", arr.release == NULL, ch.release == NULL);
+	}
+	sch.release(&sch);
+	printf("%d\n", sch.release == NULL);
+
+	cots_fini_tsoa(&c.proto, db);
+	cots_close_ts(db);
+	return 0;
+}
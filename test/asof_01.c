@@ -0,0 +1,71 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <cotse.h>
+
+#define NTICKS	(20000U)
+
+struct candle {
+    	struct cots_tick_s proto;
+        cots_qx_t q;
+    	cots_px_t p;
+};
+
+static cots_to_t
+mktoff(size_t i)
+{
+	return 1000U + i * 1000U + (i * 7919U) % 13U;
+}
+
+static void
+asof(cots_ts_t db, cots_to_t t)
+{
+	struct candle c;
+
+	if (cots_asof(db, t, &c.proto) < 0) {
+		printf("%lu\tnone\n", t);
+		return;
+	}
+	printf("%lu\t%lu\t%d\n", t, c.proto.toff, (int)c.q);
+	return;
+}
+
+static void
+asofs(cots_ts_t db)
+{
+	/* before the first tick */
+	asof(db, 0U);
+	/* exactly the first tick */
+	asof(db, mktoff(0U));
+	/* between ticks */
+	asof(db, mktoff(100U) + 1U);
+	asof(db, mktoff(101U) - 1U);
+	/* last tick of the first page, then the first of the second */
+	asof(db, mktoff(8192U) - 1U);
+	asof(db, mktoff(8192U));
+	/* back to the first page */
+	asof(db, mktoff(5U));
+	/* tail */
+	asof(db, mktoff(19999U));
+	asof(db, (cots_to_t)-1);
+	return;
+}
+
+int main(void)
+{
+	cots_ts_t db = make_cots_ts("qp", 0U);
+
+	cots_attach(db, "asof_01.cots", O_CREAT | O_TRUNC | O_RDWR);
+	for (size_t i = 0U; i < NTICKS; i++) {
+		struct candle t = {{mktoff(i)}, (cots_qx_t)i, 1.df};
+		cots_write_tick(db, &t.proto);
+	}
+	/* with ticks still in the WAL */
+	asofs(db);
+	cots_detach(db);
+	free_cots_ts(db);
+
+	db = cots_open_ts("asof_01.cots", O_RDONLY);
+	asofs(db);
+	cots_close_ts(db);
+	return 0;
+}
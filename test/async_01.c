@@ -0,0 +1,35 @@
+#include <stdio.h>
+#include "candle.h"
+
+#define NTICKS	(30000U)
+
+int main(void)
+{
+	cots_ts_t db = make_cots_ts("qp", 1000U);
+	size_t ntot;
+	size_t nbad = 0U;
+	int rc = 0;
+
+	cots_attach(db, "async_01.cots", O_CREAT | O_TRUNC | O_RDWR);
+	if (cots_async_flush(db, 1) < 0) {
+		puts("no worker");
+		return 1;
+	}
+	rc |= candle_write(db, 0U, NTICKS / 2U);
+	/* back to synchronous flushing half-way */
+	rc |= cots_async_flush(db, 0);
+	rc |= candle_write(db, NTICKS / 2U, NTICKS / 2U + 1234U);
+	rc |= cots_async_flush(db, 1);
+	rc |= candle_write(db, NTICKS / 2U + 1234U, NTICKS);
+	/* time mustn't go backwards, not even across hand-overs */
+	{
+		struct candle t = candle(0U);
+		printf("%d\n", cots_write_tick(db, &t.proto));
+	}
+	cots_detach(db);
+	free_cots_ts(db);
+
+	ntot = candle_check("async_01.cots", &nbad);
+	printf("%d\t%zu\t%zu\n", rc, ntot, nbad);
+	return 0;
+}
@@ -0,0 +1,93 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <cotse.h>
+
+#define NTICKS	(20000U)
+
+struct quote {
+	struct cots_tick_s proto;
+	cots_qx_t q;
+	cots_to_t c;
+	cots_tag_t z;
+	cots_px_t p;
+};
+
+struct quote_soa {
+	struct cots_tsoa_s proto;
+	cots_qx_t *q;
+	cots_to_t *c;
+	cots_tag_t *z;
+	cots_px_t *p;
+};
+
+static struct quote
+mkquot(size_t i)
+{
+	return (struct quote){
+		{i * 1000U + (i * 7919U) % 13U},
+		(cots_qx_t)(i % 977U) / 100.dd,
+		10U * i + i % 7U,
+		(i * 2654435761U) % 100000U,
+		(cots_px_t)((i * 31U) % 5003U),
+	};
+}
+
+static void
+seek(cots_ts_t db, struct quote_soa *c, size_t row)
+{
+	const struct quote t = mkquot(row);
+	size_t ntot = 0U;
+	size_t nbad = 0U;
+	ssize_t n;
+
+	if (cots_seek(db, t.proto.toff) < 0) {
+		puts("seek failed");
+		return;
+	}
+	while ((n = cots_read_ticks(&c->proto, db)) > 0) {
+		for (size_t i = 0U; i < (size_t)n; i++) {
+			const struct quote x = mkquot(row + ntot + i);
+
+			nbad += c->proto.toffs[i] != x.proto.toff ||
+				c->q[i] != x.q || c->c[i] != x.c ||
+				c->z[i] != x.z || c->p[i] != x.p;
+		}
+		ntot += n;
+	}
+	printf("%zu\t%zu\t%zu\n", row, ntot, nbad);
+	return;
+}
+
+int main(void)
+{
+	cots_ts_t db = make_cots_ts("qczp", 0U);
+	struct quote_soa c;
+
+	cots_block_dirs(db, 1);
+	cots_attach(db, "bdir_01.cots", O_CREAT | O_TRUNC | O_RDWR);
+	for (size_t i = 0U; i < NTICKS; i++) {
+		struct quote t = mkquot(i);
+		cots_write_tick(db, &t.proto);
+	}
+	cots_detach(db);
+	free_cots_ts(db);
+
+	db = cots_open_ts("bdir_01.cots", O_RDONLY);
+	cots_init_tsoa(&c.proto, db);
+	/* first block */
+	seek(db, &c, 0U);
+	seek(db, &c, 127U);
+	/* block boundaries and the middles of blocks */
+	seek(db, &c, 128U);
+	seek(db, &c, 129U);
+	seek(db, &c, 5000U);
+	seek(db, &c, 8191U);
+	/* second page */
+	seek(db, &c, 8192U);
+	seek(db, &c, 8192U + 1000U);
+	/* last page, last block */
+	seek(db, &c, 19999U);
+	cots_fini_tsoa(&c.proto, db);
+	cots_close_ts(db);
+	return 0;
+}
@@ -0,0 +1,83 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <cotse.h>
+
+#define NTICKS	(20000U)
+
+struct candle {
+    	struct cots_tick_s proto;
+        cots_qx_t q;
+    	cots_px_t p;
+};
+
+struct candle_soa {
+    	struct cots_tsoa_s proto;
+        cots_qx_t *q;
+    	cots_px_t *p;
+};
+
+static void
+wr(size_t off)
+{
+	cots_ts_t db = make_cots_ts("qp", 0U);
+
+	cots_attach(db, "cache_01.cots", O_CREAT | O_TRUNC | O_RDWR);
+	for (size_t i = 0U; i < NTICKS; i++) {
+		struct candle t = {{i}, (cots_qx_t)(i + off), 1.df};
+		cots_write_tick(db, &t.proto);
+	}
+	cots_detach(db);
+	free_cots_ts(db);
+	return;
+}
+
+static void
+rd(cots_ts_t db, size_t off)
+{
+	struct candle_soa c;
+	size_t nbad = 0U;
+	size_t ntot = 0U;
+	ssize_t n;
+
+	cots_init_tsoa(&c.proto, db);
+	cots_seek(db, 0U);
+	while ((n = cots_read_ticks(&c.proto, db)) > 0) {
+		for (ssize_t j = 0; j < n; j++) {
+			nbad += c.q[j] != (cots_qx_t)(c.proto.toffs[j] + off);
+		}
+		ntot += n;
+	}
+	cots_fini_tsoa(&c.proto, db);
+	printf("%zu\t%zu\n", ntot, nbad);
+	return;
+}
+
+int main(void)
+{
+	cots_ts_t db1, db2;
+
+	cots_page_cache(64U << 20U);
+
+	wr(0U);
+	db1 = cots_open_ts("cache_01.cots", O_RDONLY);
+	db2 = cots_open_ts("cache_01.cots", O_RDONLY);
+	/* second handle is served from the cache */
+	rd(db1, 0U);
+	rd(db2, 0U);
+	rd(db1, 0U);
+	cots_close_ts(db1);
+	cots_close_ts(db2);
+
+	/* rewrite the file, cached pages must not come back */
+	wr(1U);
+	db1 = cots_open_ts("cache_01.cots", O_RDONLY);
+	rd(db1, 1U);
+	cots_close_ts(db1);
+
+	/* and turn it off again */
+	cots_page_cache(0U);
+	db1 = cots_open_ts("cache_01.cots", O_RDONLY);
+	rd(db1, 1U);
+	cots_close_ts(db1);
+	return 0;
+}
@@ -0,0 +1,83 @@
+/* candle fixture, tick X is at time 10X with quantity and price X */
+#if !defined INCLUDED_candle_h_
+#define INCLUDED_candle_h_
+#include <fcntl.h>
+#include <cotse.h>
+
+struct candle {
+	struct cots_tick_s proto;
+	cots_qx_t q;
+	cots_px_t p;
+};
+
+struct candle_soa {
+	struct cots_tsoa_s proto;
+	cots_qx_t *q;
+	cots_px_t *p;
+};
+
+static inline struct candle
+candle(size_t x)
+{
+	return (struct candle){{x * 10U}, (cots_qx_t)x, (cots_px_t)x};
+}
+
+static inline int
+candle_write(cots_ts_t db, size_t from, size_t till)
+{
+/* write ticks FROM till TILL one by one */
+	int rc = 0;
+
+	for (size_t x = from; x < till; x++) {
+		struct candle t = candle(x);
+		rc |= cots_write_tick(db, &t.proto);
+	}
+	return rc;
+}
+
+static inline size_t
+candle_nbad(const struct candle_soa *c, size_t n, size_t from)
+{
+/* count the N ticks in C that aren't ticks FROM onwards */
+	size_t nbad = 0U;
+
+	for (size_t i = 0U; i < n; i++) {
+		const size_t x = from + i;
+
+		nbad += c->proto.toffs[i] != x * 10U ||
+			c->q[i] != (cots_qx_t)x || c->p[i] != (cots_px_t)x;
+	}
+	return nbad;
+}
+
+static inline size_t
+candle_read(cots_ts_t db, struct candle_soa *c, size_t from, size_t *nbad)
+{
+/* read the rest of DB, whose next tick ought to be FROM,
+ * return the number of ticks read and add the bad ones to NBAD */
+	size_t ntot = 0U;
+	ssize_t n;
+
+	while ((n = cots_read_ticks(&c->proto, db)) > 0) {
+		*nbad += candle_nbad(c, n, from + ntot);
+		ntot += n;
+	}
+	return ntot;
+}
+
+static inline size_t
+candle_check(const char *fn, size_t *nbad)
+{
+/* read all of file FN, like candle_read() */
+	cots_ts_t db = cots_open_ts(fn, O_RDONLY);
+	struct candle_soa c;
+	size_t ntot;
+
+	cots_init_tsoa(&c.proto, db);
+	ntot = candle_read(db, &c, 0U, nbad);
+	cots_fini_tsoa(&c.proto, db);
+	cots_close_ts(db);
+	return ntot;
+}
+
+#endif	/* INCLUDED_candle_h_ */
@@ -0,0 +1,76 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <cotse.h>
+
+#define NTICKS	(20000U)
+
+struct candle {
+    	struct cots_tick_s proto;
+        cots_qx_t q;
+    	cots_px_t p;
+};
+
+static cots_to_t
+mktoff(size_t i)
+{
+	/* three ticks per time stamp, so pages share them */
+	return i / 3U * 1000U;
+}
+
+static size_t
+brute(cots_to_t from, cots_to_t till)
+{
+	size_t n = 0U;
+
+	for (size_t i = 0U; i < NTICKS; i++) {
+		n += mktoff(i) >= from && mktoff(i) < till;
+	}
+	return n;
+}
+
+static void
+count(cots_ts_t db)
+{
+	static const cots_to_t rng[][2U] = {
+		{0U, -1ULL},
+		{0U, 1U},
+		{1000000U, 2000000U},
+		{1000001U, 5000000U},
+		{341000U, 342000U},
+		{2000000U, 6666000U},
+		{6666000U, 6667000U},
+		{6665000U, -1ULL},
+		{7000000U, -1ULL},
+		{5000U, 5000U},
+	};
+	size_t nbad = 0U;
+
+	for (size_t i = 0U; i < sizeof(rng) / sizeof(*rng); i++) {
+		ssize_t n = cots_count(db, rng[i][0U], rng[i][1U]);
+
+		printf("%zd\n", n);
+		nbad += (size_t)n != brute(rng[i][0U], rng[i][1U]);
+	}
+	printf("%zu\n", nbad);
+	return;
+}
+
+int main(void)
+{
+	cots_ts_t db = make_cots_ts("qp", 1024U);
+
+	cots_attach(db, "count_01.cots", O_CREAT | O_TRUNC | O_RDWR);
+	for (size_t i = 0U; i < NTICKS; i++) {
+		struct candle t = {{mktoff(i)}, 1.dd, 1.df};
+		cots_write_tick(db, &t.proto);
+	}
+	/* some of the ticks are still in the WAL */
+	count(db);
+	cots_detach(db);
+	free_cots_ts(db);
+
+	db = cots_open_ts("count_01.cots", O_RDONLY);
+	count(db);
+	cots_close_ts(db);
+	return 0;
+}
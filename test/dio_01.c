@@ -0,0 +1,54 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <unistd.h>
+#include "candle.h"
+
+#define NTICKS	(30000U)
+
+static void
+scan(cots_ts_t db, struct candle_soa *c, size_t from)
+{
+	size_t nbad = 0U;
+	size_t ntot;
+
+	cots_seek(db, from * 10U);
+	ntot = candle_read(db, c, from, &nbad);
+	printf("%zu\t%zu\t%zu\n", from, ntot, nbad);
+	return;
+}
+
+int main(void)
+{
+	cots_ts_t db = make_cots_ts("qp", 1000U);
+	struct candle_soa c;
+
+	cots_attach(db, "dio_01.cots", O_CREAT | O_TRUNC | O_RDWR);
+	candle_write(db, 0U, NTICKS);
+	cots_detach(db);
+	free_cots_ts(db);
+
+	/* results mustn't depend on the page cache */
+	db = cots_open_ts("dio_01.cots", O_RDONLY | O_DIRECT);
+	cots_stats_enable(db, 1);
+	cots_init_tsoa(&c.proto, db);
+	scan(db, &c, 0U);
+	/* mid-page */
+	scan(db, &c, 12345U);
+	/* back to the start, behind the read window */
+	scan(db, &c, 999U);
+	cots_fini_tsoa(&c.proto, db);
+
+	/* pages were read directly unless the file system can't do that */
+	{
+		struct cots_stats_s st;
+		const int fd = open("dio_01.cots", O_RDONLY | O_DIRECT);
+
+		cots_stats(db, &st);
+		printf("%d\n", (fd >= 0) == (st.ndirect > 0U));
+		if (fd >= 0) {
+			close(fd);
+		}
+	}
+	cots_close_ts(db);
+	return 0;
+}
@@ -0,0 +1,40 @@
+#include <stdio.h>
+#include "candle.h"
+
+#define NTICKS	(30000U)
+
+static void
+check(const char *fn)
+{
+	size_t nbad = 0U;
+	size_t ntot = candle_check(fn, &nbad);
+
+	printf("%zu\t%zu\n", ntot, nbad);
+	return;
+}
+
+int main(void)
+{
+	cots_ts_t db1 = make_cots_ts("qp", 1000U);
+	cots_ts_t db2 = make_cots_ts("qp", 1000U);
+	int rc = 0;
+
+	cots_attach(db1, "dur_01a.cots", O_CREAT | O_TRUNC | O_RDWR);
+	cots_attach(db2, "dur_01b.cots", O_CREAT | O_TRUNC | O_RDWR);
+	printf("%d\n", cots_durability(db1, 8U, 0U, 0U));
+	rc |= cots_durability(db1, COTS_SYNC_WAL | COTS_SYNC_PAGE, 100U, 0U);
+	rc |= cots_durability(db2, COTS_SYNC_WAL | COTS_SYNC_GROUP, 0U, 1000U);
+	for (size_t i = 0U; i < NTICKS; i++) {
+		struct candle t = candle(i);
+
+		rc |= cots_write_tick(db1, &t.proto);
+		rc |= cots_write_tick(db2, &t.proto);
+	}
+	printf("%d\n", rc);
+	free_cots_ts(db1);
+	free_cots_ts(db2);
+
+	check("dur_01a.cots");
+	check("dur_01b.cots");
+	return 0;
+}
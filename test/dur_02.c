@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "candle.h"
+
+static void
+crash(const char *fn, int fl, size_t from, size_t till)
+{
+/* write ticks FROM till TILL to FN and die without detaching */
+	pid_t p;
+
+	if ((p = fork()) == 0) {
+		cots_ts_t db;
+
+		if (fl & O_CREAT) {
+			db = make_cots_ts("qp", 1024U);
+			cots_attach(db, fn, fl);
+		} else {
+			db = cots_open_ts(fn, fl);
+		}
+		cots_durability(db, COTS_SYNC_WAL, 100U, 0U);
+		_exit(candle_write(db, from, till) < 0);
+	}
+	waitpid(p, NULL, 0);
+	return;
+}
+
+static void
+reopen(const char *fn, size_t from, size_t till)
+{
+	cots_ts_t db = cots_open_ts(fn, O_RDWR);
+
+	printf("%d\n", candle_write(db, from, till));
+	cots_close_ts(db);
+	return;
+}
+
+static void
+check(const char *fn)
+{
+	size_t nbad = 0U;
+	size_t ntot = candle_check(fn, &nbad);
+
+	printf("%zu\t%zu\n", ntot, nbad);
+	return;
+}
+
+static void
+copy(const char *tgt, const char *src)
+{
+	char buf[4096U];
+	FILE *fi = fopen(src, "rb");
+	FILE *fo = fopen(tgt, "wb");
+
+	for (size_t n; (n = fread(buf, 1U, sizeof(buf), fi)) > 0U;) {
+		fwrite(buf, 1U, n, fo);
+	}
+	fclose(fi);
+	fclose(fo);
+	return;
+}
+
+int main(void)
+{
+	/* two full pages and a WAL of 952 ticks */
+	crash("dur_02a.cots", O_CREAT | O_TRUNC | O_RDWR, 0U, 3000U);
+	copy("dur_02a.wal.bak", "dur_02a.cots.wal");
+	reopen("dur_02a.cots", 3000U, 4000U);
+	check("dur_02a.cots");
+
+	/* a WAL whose ticks went to the file already stays out */
+	copy("dur_02a.cots.wal", "dur_02a.wal.bak");
+	unlink("dur_02a.wal.bak");
+	reopen("dur_02a.cots", 4000U, 4100U);
+	check("dur_02a.cots");
+
+	/* ticks of the yanked last page are in the WAL and the file */
+	crash("dur_02a.cots", O_RDWR, 4100U, 4500U);
+	reopen("dur_02a.cots", 4500U, 4600U);
+	check("dur_02a.cots");
+
+	/* no page at all */
+	crash("dur_02b.cots", O_CREAT | O_TRUNC | O_RDWR, 0U, 500U);
+	reopen("dur_02b.cots", 500U, 600U);
+	check("dur_02b.cots");
+	return 0;
+}
@@ -0,0 +1,85 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <cotse.h>
+
+#define NTICKS	(50000U)
+
+struct candle {
+    	struct cots_tick_s proto;
+        cots_qx_t q;
+    	cots_px_t p;
+};
+
+struct candle_soa {
+    	struct cots_tsoa_s proto;
+        cots_qx_t *q;
+    	cots_px_t *p;
+};
+
+static void
+filt(cots_ts_t db, struct candle_soa *c, const struct cots_pred_s *p, size_t np)
+{
+	size_t ntot = 0U;
+	size_t nbad = 0U;
+	ssize_t n;
+
+	cots_seek(db, 0U);
+	while ((n = cots_read_filt(&c->proto, db, p, np)) > 0) {
+		for (ssize_t j = 0; j < n; j++) {
+			/* time offsets are the tick numbers */
+			nbad += c->q[j] != (cots_qx_t)c->proto.toffs[j];
+		}
+		ntot += n;
+	}
+	printf("%zu\t%zu\n", ntot, nbad);
+	return;
+}
+
+static void
+filts(cots_ts_t db)
+{
+	struct candle_soa c;
+
+	cots_init_tsoa(&c.proto, db);
+	/* late pages only */
+	filt(db, &c, (struct cots_pred_s[]){
+			{0U, COTS_OP_GT, {.qx = 45000.dd}}}, 1U);
+	/* nothing at all */
+	filt(db, &c, (struct cots_pred_s[]){
+			{0U, COTS_OP_GE, {.qx = 50000.dd}}}, 1U);
+	/* spread over all pages */
+	filt(db, &c, (struct cots_pred_s[]){
+			{1U, COTS_OP_EQ, {.px = 7.df}}}, 1U);
+	/* both */
+	filt(db, &c, (struct cots_pred_s[]){
+			{0U, COTS_OP_LT, {.qx = 10000.dd}},
+			{1U, COTS_OP_EQ, {.px = 7.df}}}, 2U);
+	/* bogus operator */
+	printf("%zd\n", cots_read_filt(&c.proto, db, (struct cots_pred_s[]){
+			{0U, '!', {.qx = 0.dd}}}, 1U));
+	cots_fini_tsoa(&c.proto, db);
+	return;
+}
+
+int main(void)
+{
+	cots_ts_t db = make_cots_ts("qp", 0U);
+
+	cots_attach(db, "filt_01.cots", O_CREAT | O_TRUNC | O_RDWR);
+	for (size_t i = 0U; i < NTICKS; i++) {
+		struct candle t = {
+			{i}, (cots_qx_t)i, (cots_px_t)(int)(i % 100U)
+		};
+		cots_write_tick(db, &t.proto);
+	}
+	/* zone maps from the writer */
+	filts(db);
+	cots_detach(db);
+	free_cots_ts(db);
+
+	/* zone maps from the index */
+	db = cots_open_ts("filt_01.cots", O_RDONLY);
+	filts(db);
+	cots_close_ts(db);
+	return 0;
+}
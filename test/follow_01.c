@@ -0,0 +1,77 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <cotse.h>
+
+struct candle {
+    	struct cots_tick_s proto;
+        cots_qx_t q;
+    	cots_px_t p;
+};
+
+struct candle_soa {
+    	struct cots_tsoa_s proto;
+        cots_qx_t *q;
+    	cots_px_t *p;
+};
+
+static size_t nwr;
+static size_t nrd;
+
+static void
+wr(cots_ts_t db, size_t n)
+{
+	for (size_t i = 0U; i < n; i++, nwr++) {
+		struct candle t = {{nwr}, (cots_qx_t)nwr, 1.df};
+		cots_write_tick(db, &t.proto);
+	}
+	return;
+}
+
+static void
+rd(cots_ts_t db, struct candle_soa *c)
+{
+	size_t nbad = 0U;
+	ssize_t n;
+
+	while ((n = cots_read_ticks(&c->proto, db)) > 0) {
+		for (ssize_t j = 0; j < n; j++, nrd++) {
+			nbad += c->proto.toffs[j] != nrd;
+			nbad += c->q[j] != (cots_qx_t)nrd;
+		}
+	}
+	printf("%zu\t%zu\t%zu\n", nwr, nrd, nbad);
+	return;
+}
+
+int main(void)
+{
+	cots_ts_t wdb = make_cots_ts("qp", 0U);
+	cots_ts_t rdb;
+	struct candle_soa c;
+
+	cots_attach(wdb, "follow_01.cots", O_CREAT | O_TRUNC | O_RDWR);
+	rdb = cots_open_ts("follow_01.cots", O_RDONLY);
+	cots_follow(rdb);
+	cots_init_tsoa(&c.proto, rdb);
+
+	/* nothing yet */
+	rd(rdb, &c);
+	/* ticks only in the WAL */
+	wr(wdb, 1000U);
+	rd(rdb, &c);
+	/* some of them get flushed meanwhile */
+	wr(wdb, 8000U);
+	rd(rdb, &c);
+	/* several pages at once */
+	wr(wdb, 30000U);
+	rd(rdb, &c);
+	/* writer goes away */
+	wr(wdb, 5U);
+	cots_detach(wdb);
+	free_cots_ts(wdb);
+	rd(rdb, &c);
+
+	cots_fini_tsoa(&c.proto, rdb);
+	cots_close_ts(rdb);
+	return 0;
+}
@@ -0,0 +1,87 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <cotse.h>
+
+#define NSRC	(3U)
+
+struct candle {
+	struct cots_tick_s proto;
+	cots_qx_t q;
+	cots_px_t p;
+};
+
+struct candle_soa {
+	struct cots_tsoa_s proto;
+	cots_qx_t *q;
+	cots_px_t *p;
+};
+
+static const size_t mul[NSRC] = {2U, 3U, 5U};
+static const size_t nticks[NSRC] = {10000U, 7000U, 4000U};
+
+static void
+mkfile(size_t k)
+{
+	cots_ts_t db = make_cots_ts("qp", 1024U);
+	char fn[] = "merge_01_x.cots";
+
+	fn[9U] = (char)('0' + k);
+	cots_attach(db, fn, O_CREAT | O_TRUNC | O_RDWR);
+	for (size_t i = 0U; i < nticks[k]; i++) {
+		struct candle t = {{mul[k] * i}, (cots_qx_t)k, (cots_px_t)i};
+		cots_write_tick(db, &t.proto);
+	}
+	cots_detach(db);
+	free_cots_ts(db);
+	return;
+}
+
+int main(void)
+{
+	cots_ts_t db[NSRC];
+	size_t src[1024U];
+	size_t cnt[NSRC] = {0U};
+	size_t ntot = 0U;
+	size_t nbad = 0U;
+	cots_to_t last = 0U;
+	size_t lsrc = 0U;
+	struct candle_soa c;
+	cots_mrg_t m;
+	ssize_t n;
+
+	for (size_t k = 0U; k < NSRC; k++) {
+		char fn[] = "merge_01_x.cots";
+
+		fn[9U] = (char)('0' + k);
+		mkfile(k);
+		db[k] = cots_open_ts(fn, O_RDONLY);
+	}
+	/* start the last one somewhere in the middle */
+	cots_seek(db[2U], 5000U);
+
+	m = make_cots_mrg(db, NSRC);
+	cots_init_tsoa(&c.proto, db[0U]);
+	while ((n = cots_read_mrg(&c.proto, src, m)) > 0) {
+		for (size_t i = 0U; i < (size_t)n; i++) {
+			const cots_to_t t = c.proto.toffs[i];
+			const size_t k = src[i];
+
+			/* time order, series order on ties */
+			nbad += t < last || (t == last && k < lsrc);
+			/* rows must stay intact */
+			nbad += k >= NSRC || c.q[i] != (cots_qx_t)k ||
+				t != mul[k] * (size_t)c.p[i];
+			cnt[k % NSRC]++;
+			last = t, lsrc = k;
+		}
+		ntot += n;
+	}
+	printf("%zu\t%zu\t%zu\t%zu\t%zu\n", ntot, cnt[0U], cnt[1U], cnt[2U], nbad);
+	cots_fini_tsoa(&c.proto, db[0U]);
+	free_cots_mrg(m);
+
+	for (size_t k = 0U; k < NSRC; k++) {
+		cots_close_ts(db[k]);
+	}
+	return 0;
+}
@@ -0,0 +1,76 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <cotse.h>
+
+#define NTICKS	(50000U)
+
+struct candle {
+    	struct cots_tick_s proto;
+        cots_qx_t q;
+    	cots_px_t p;
+};
+
+struct candle_soa {
+    	struct cots_tsoa_s proto;
+        cots_qx_t *q;
+    	cots_px_t *p;
+};
+
+static cots_to_t
+mktoff(size_t i)
+{
+	return i * 1000U + (i * 7919U) % 13U;
+}
+
+static void
+scan(cots_ts_t db, struct candle_soa *c, size_t i)
+{
+	size_t nbad = 0U;
+	size_t ntot = 0U;
+	ssize_t n;
+
+	while ((n = cots_read_ticks(&c->proto, db)) > 0) {
+		for (ssize_t j = 0; j < n; j++, i++) {
+			nbad += c->proto.toffs[j] != mktoff(i);
+			nbad += c->q[j] != (cots_qx_t)i;
+		}
+		ntot += n;
+	}
+	printf("%zu\t%zu\n", ntot, nbad);
+	return;
+}
+
+int main(void)
+{
+	cots_ts_t db = make_cots_ts("qp", 0U);
+	struct candle_soa c;
+
+	cots_attach(db, "prefetch_01.cots", O_CREAT | O_TRUNC | O_RDWR);
+	for (size_t i = 0U; i < NTICKS; i++) {
+		struct candle t = {{mktoff(i)}, (cots_qx_t)i, 1.df};
+		cots_write_tick(db, &t.proto);
+	}
+	cots_detach(db);
+	free_cots_ts(db);
+
+	db = cots_open_ts("prefetch_01.cots", O_RDONLY);
+	cots_init_tsoa(&c.proto, db);
+	if (cots_prefetch(db, 2U) < 0) {
+		puts("prefetch failed");
+	}
+	/* straight through */
+	scan(db, &c, 0U);
+	/* go back to the middle of the second page */
+	cots_seek(db, mktoff(10000U));
+	scan(db, &c, 10000U);
+	/* page boundary */
+	cots_seek(db, mktoff(16384U));
+	scan(db, &c, 16384U);
+	/* turn it off again */
+	cots_prefetch(db, 0U);
+	cots_seek(db, 0U);
+	scan(db, &c, 0U);
+	cots_fini_tsoa(&c.proto, db);
+	cots_close_ts(db);
+	return 0;
+}
@@ -0,0 +1,52 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <cotse.h>
+
+#define NTICKS	(10000U)
+
+struct trpl {
+    	struct cots_tick_s proto;
+	uint64_t x;
+	uint64_t y;
+	uint64_t z;
+};
+
+struct trpl_soa {
+    	struct cots_tsoa_s proto;
+	uint64_t *x;
+	uint64_t *y;
+	uint64_t *z;
+};
+
+int main(void)
+{
+	cots_ts_t db = make_cots_ts("zzz", 0U);
+	struct trpl_soa c;
+	size_t ntot = 0U;
+	ssize_t n;
+
+	cots_attach(db, "proj_01.cots", O_CREAT | O_TRUNC | O_RDWR);
+	for (size_t i = 0U; i < NTICKS; i++) {
+		struct trpl t = {{i * 1000U + i % 7U}, i, 2U * i, 3U * i};
+		cots_write_tick(db, &t.proto);
+	}
+	cots_detach(db);
+	free_cots_ts(db);
+
+	db = cots_open_ts("proj_01.cots", O_RDONLY);
+	/* only x and z */
+	cots_init_tsoa_proj(&c.proto, db, 0b101U);
+	if (c.y != NULL) {
+		puts("y projected");
+	}
+	cots_seek(db, 8190U * 1000U);
+	while ((n = cots_read_ticks(&c.proto, db)) > 0) {
+		printf("%lu\t%lu\t%lu\t%zd\n",
+		       c.proto.toffs[0U], c.x[0U], c.z[0U], n);
+		ntot += n;
+	}
+	printf("%zu\n", ntot);
+	cots_fini_tsoa(&c.proto, db);
+	cots_close_ts(db);
+	return 0;
+}
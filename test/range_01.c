@@ -0,0 +1,79 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <cotse.h>
+
+#define NTICKS	(20000U)
+
+struct candle {
+    	struct cots_tick_s proto;
+        cots_qx_t q;
+    	cots_px_t p;
+};
+
+struct candle_soa {
+    	struct cots_tsoa_s proto;
+        cots_qx_t *q;
+    	cots_px_t *p;
+};
+
+static cots_to_t
+mktoff(size_t i)
+{
+	/* strictly increasing but not equidistant */
+	return i * 1000U + (i * 7919U) % 13U;
+}
+
+static void
+range(cots_ts_t db, struct candle_soa *c, cots_to_t from, cots_to_t till)
+{
+	cots_to_t lst = 0U;
+	size_t ntot = 0U;
+	ssize_t n;
+
+	while ((n = cots_read_range(&c->proto, db, from, till)) > 0) {
+		if (!ntot) {
+			printf("%lu\t", c->proto.toffs[0U]);
+		}
+		ntot += n;
+		lst = c->proto.toffs[n - 1];
+	}
+	printf("%lu\t%zu\n", lst, ntot);
+	return;
+}
+
+int main(void)
+{
+	cots_ts_t db = make_cots_ts("qp", 0U);
+	struct candle_soa c;
+
+	cots_attach(db, "range_01.cots", O_CREAT | O_TRUNC | O_RDWR);
+	for (size_t i = 0U; i < NTICKS; i++) {
+		struct candle t = {{mktoff(i)}, 1.dd, 1.df};
+		cots_write_tick(db, &t.proto);
+	}
+	cots_detach(db);
+	free_cots_ts(db);
+
+	db = cots_open_ts("range_01.cots", O_RDONLY);
+	cots_init_tsoa(&c.proto, db);
+	/* within the first page */
+	range(db, &c, mktoff(100U), mktoff(200U));
+	/* across pages */
+	range(db, &c, mktoff(8000U), mktoff(17000U));
+	/* up to a page boundary */
+	range(db, &c, mktoff(100U), mktoff(8192U));
+	/* everything */
+	range(db, &c, 0U, -1ULL);
+	/* empty */
+	range(db, &c, mktoff(200U), mktoff(100U));
+	/* read to the end, again from the start */
+	range(db, &c, mktoff(100U), mktoff(200U));
+	range(db, &c, mktoff(100U), mktoff(200U));
+	/* empty ranges are refused, even the first one */
+	cots_seek(db, mktoff(500U));
+	printf("%zd\n", cots_read_range(&c.proto, db, 0U, 0U));
+	printf("%zd\n", cots_read_range(&c.proto, db, mktoff(1U), mktoff(1U)));
+	cots_fini_tsoa(&c.proto, db);
+	cots_close_ts(db);
+	return 0;
+}
@@ -0,0 +1,44 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "candle.h"
+
+#define NTICKS	(25000U)
+#define NBUF	(4500U)
+
+int main(void)
+{
+	cots_ts_t db = make_cots_ts("qp", 1000U);
+	struct candle_soa c;
+	size_t ntot = 0U;
+	size_t nbad = 0U;
+	ssize_t n;
+
+	cots_attach(db, "readn_01.cots", O_CREAT | O_TRUNC | O_RDWR);
+	candle_write(db, 0U, NTICKS);
+	cots_detach(db);
+	free_cots_ts(db);
+
+	db = cots_open_ts("readn_01.cots", O_RDONLY);
+	c.proto.toffs = malloc(NBUF * sizeof(*c.proto.toffs));
+	c.q = malloc(NBUF * sizeof(*c.q));
+	c.p = malloc(NBUF * sizeof(*c.p));
+
+	/* start in the middle of the first page */
+	cots_seek(db, 5000U);
+	while ((n = cots_read_ticks_n(&c.proto, db, NBUF)) > 0) {
+		nbad += candle_nbad(&c, n, 500U + ntot);
+		printf("%zd\n", n);
+		ntot += n;
+	}
+	printf("%zu\t%zu\n", ntot, nbad);
+
+	/* buffers smaller than a page won't do */
+	cots_seek(db, 0U);
+	printf("%zd\n", cots_read_ticks_n(&c.proto, db, 999U));
+
+	free(c.proto.toffs);
+	free(c.q);
+	free(c.p);
+	cots_close_ts(db);
+	return 0;
+}
@@ -0,0 +1,84 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <cotse.h>
+
+#define NTICKS	(20000U)
+
+struct candle {
+    	struct cots_tick_s proto;
+        cots_qx_t q;
+    	cots_px_t p;
+};
+
+struct candle_soa {
+    	struct cots_tsoa_s proto;
+        cots_qx_t *q;
+    	cots_px_t *p;
+};
+
+static cots_to_t
+mktoff(size_t i)
+{
+	return i * 1000U + (i * 7919U) % 13U;
+}
+
+static void
+rev(cots_ts_t db, struct candle_soa *c, cots_to_t from, size_t i)
+{
+	size_t nbad = 0U;
+	size_t ntot = 0U;
+	ssize_t n;
+
+	cots_seek(db, from);
+	if ((n = cots_read_ticks_rev(&c->proto, db)) > 0) {
+		printf("%lu\t%zd", c->proto.toffs[0U], n);
+	}
+	for (; n > 0; n = cots_read_ticks_rev(&c->proto, db)) {
+		for (ssize_t j = 0; j < n; j++) {
+			i--;
+			nbad += c->proto.toffs[j] != mktoff(i);
+			nbad += c->q[j] != (cots_qx_t)i;
+		}
+		ntot += n;
+	}
+	printf("\t%zu\t%zu\n", ntot, nbad);
+	return;
+}
+
+static void
+revs(cots_ts_t db)
+{
+	struct candle_soa c;
+
+	cots_init_tsoa(&c.proto, db);
+	/* from the tail */
+	rev(db, &c, (cots_to_t)-1, NTICKS);
+	/* most recent tick before some time stamp */
+	rev(db, &c, mktoff(10000U), 10000U);
+	/* on a page boundary */
+	rev(db, &c, mktoff(8192U), 8192U);
+	/* at the very beginning */
+	rev(db, &c, 0U, 0U);
+	cots_fini_tsoa(&c.proto, db);
+	return;
+}
+
+int main(void)
+{
+	cots_ts_t db = make_cots_ts("qp", 0U);
+
+	cots_attach(db, "rev_01.cots", O_CREAT | O_TRUNC | O_RDWR);
+	for (size_t i = 0U; i < NTICKS; i++) {
+		struct candle t = {{mktoff(i)}, (cots_qx_t)i, 1.df};
+		cots_write_tick(db, &t.proto);
+	}
+	/* with ticks still in the WAL */
+	revs(db);
+	cots_detach(db);
+	free_cots_ts(db);
+
+	db = cots_open_ts("rev_01.cots", O_RDONLY);
+	revs(db);
+	cots_close_ts(db);
+	return 0;
+}
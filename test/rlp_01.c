@@ -0,0 +1,193 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <cotse.h>
+
+#define NTICKS	(20000U)
+
+struct candle {
+    	struct cots_tick_s proto;
+        cots_qx_t q;
+    	cots_px_t p;
+};
+
+struct bars {
+    	struct cots_tsoa_s proto;
+	cots_px_t *o;
+	cots_px_t *h;
+	cots_px_t *l;
+	cots_px_t *c;
+        cots_qx_t *v;
+};
+
+static void
+wr(cots_ts_t db, size_t from, size_t till)
+{
+	for (size_t i = from; i < till; i++) {
+		/* a tick every second, prices going up and down */
+		struct candle t = {
+			{i * 1000000000ULL}, 2.dd,
+			(cots_px_t)(int)(i % 100U < 50U ? i % 100U : 100U - i % 100U)
+		};
+		cots_write_tick(db, &t.proto);
+	}
+	return;
+}
+
+struct wide {
+	struct cots_tick_s proto;
+	cots_qx_t q;
+	cots_px_t p;
+	cots_px_t b;
+	cots_px_t a;
+};
+
+static void
+wr_wide(cots_ts_t db, size_t from, size_t till)
+{
+	for (size_t i = from; i < till; i++) {
+		struct wide t = {
+			{i * 1000000000ULL}, 1.dd, (cots_px_t)(int)i, 0.df, 0.df
+		};
+		cots_write_tick(db, &t.proto);
+	}
+	return;
+}
+
+static void
+rlp_wide(cots_ts_t db, cots_to_t ival, size_t from)
+{
+	cots_ts_t rs = cots_rollup(db, ival);
+	struct bars b;
+	size_t nb = 0U;
+	size_t ndup = 0U;
+	double vol = 0.;
+	cots_to_t last = 0U;
+	int lo = 0, lc = 0, lv = 0;
+	ssize_t n;
+
+	if (rs == NULL) {
+		puts("no rollup");
+		return;
+	} else if (cots_seek(rs, from * ival) < 0) {
+		puts("no seek");
+		return;
+	}
+	cots_init_tsoa(&b.proto, rs);
+	while ((n = cots_read_ticks(&b.proto, rs)) > 0) {
+		for (ssize_t j = 0; j < n; j++, nb++) {
+			if (!nb) {
+				printf("%lu\t%d\t%d\n", b.proto.toffs[j],
+				       (int)b.o[j], (int)b.c[j]);
+			}
+			ndup += nb && b.proto.toffs[j] <= last;
+			last = b.proto.toffs[j];
+			lo = (int)b.o[j];
+			lc = (int)b.c[j];
+			lv = (int)b.v[j];
+			vol += (double)b.v[j];
+		}
+	}
+	printf("%lu\t%d\t%d\t%d\n", last, lo, lc, lv);
+	printf("%zu\t%zu\t%.0f\n", nb, ndup, vol);
+	cots_fini_tsoa(&b.proto, rs);
+	return;
+}
+
+static void
+rlp(cots_ts_t db, cots_to_t ival)
+{
+	cots_ts_t rs = cots_rollup(db, ival);
+	struct bars b;
+	size_t nb = 0U;
+	double vol = 0.;
+	ssize_t n;
+
+	if (rs == NULL) {
+		puts("no rollup");
+		return;
+	}
+	cots_init_tsoa(&b.proto, rs);
+	while ((n = cots_read_ticks(&b.proto, rs)) > 0) {
+		for (ssize_t j = 0; j < n; j++, nb++) {
+			if (nb < 2U) {
+				printf("%lu\t%d\t%d\t%d\t%d\t%d\n",
+				       b.proto.toffs[j],
+				       (int)b.o[j], (int)b.h[j],
+				       (int)b.l[j], (int)b.c[j],
+				       (int)b.v[j]);
+			}
+			vol += (double)b.v[j];
+		}
+	}
+	printf("%zu\t%.0f\n", nb, vol);
+	cots_fini_tsoa(&b.proto, rs);
+	return;
+}
+
+int main(void)
+{
+	static const cots_to_t ivals[] = {60000000000ULL, 3600000000000ULL};
+	cots_ts_t db = make_cots_ts("qp", 0U);
+
+	cots_attach(db, "rlp_01.cots", O_CREAT | O_TRUNC | O_RDWR);
+	if (cots_put_rollups(db, ivals, 2U) < 0) {
+		puts("rollups refused");
+	}
+	wr(db, 0U, NTICKS);
+	cots_detach(db);
+	free_cots_ts(db);
+
+	db = cots_open_ts("rlp_01.cots", O_RDONLY);
+	rlp(db, ivals[0U]);
+	rlp(db, ivals[1U]);
+	rlp(db, 1000000000ULL);
+	cots_close_ts(db);
+
+	/* carry on writing, the last bars have to pick up the new ticks */
+	db = cots_open_ts("rlp_01.cots", O_RDWR);
+	wr(db, NTICKS, NTICKS + 100U);
+	cots_close_ts(db);
+
+	db = cots_open_ts("rlp_01.cots", O_RDONLY);
+	rlp(db, ivals[0U]);
+	rlp(db, ivals[1U]);
+	/* and the ticks themselves are unharmed */
+	{
+		struct {
+			struct cots_tsoa_s proto;
+			cots_qx_t *q;
+			cots_px_t *p;
+		} t;
+		size_t nt = 0U;
+		ssize_t n;
+
+		cots_init_tsoa(&t.proto, db);
+		while ((n = cots_read_ticks(&t.proto, db)) > 0) {
+			nt += n;
+		}
+		cots_fini_tsoa(&t.proto, db);
+		printf("%zu\n", nt);
+	}
+	cots_close_ts(db);
+
+	/* more than two fields, with the last bar ending a full page */
+	db = make_cots_ts("qppp", 512U);
+	cots_attach(db, "rlp_01.cots", O_CREAT | O_TRUNC | O_RDWR);
+	if (cots_put_rollups(db, ivals, 1U) < 0) {
+		puts("rollups refused");
+	}
+	wr_wide(db, 0U, 1024U * 60U - 30U);
+	cots_detach(db);
+	free_cots_ts(db);
+
+	/* finish the last bar */
+	db = cots_open_ts("rlp_01.cots", O_RDWR);
+	wr_wide(db, 1024U * 60U - 30U, 1024U * 60U);
+	cots_close_ts(db);
+
+	db = cots_open_ts("rlp_01.cots", O_RDONLY);
+	rlp_wide(db, ivals[0U], 0U);
+	rlp_wide(db, ivals[0U], 700U);
+	cots_close_ts(db);
+	return 0;
+}
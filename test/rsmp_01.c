@@ -0,0 +1,74 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <cotse.h>
+
+#define NTICKS	(20000U)
+
+struct candle {
+    	struct cots_tick_s proto;
+        cots_qx_t q;
+    	cots_px_t p;
+};
+
+struct bars {
+    	struct cots_tsoa_s proto;
+	cots_px_t *o;
+	cots_px_t *h;
+	cots_px_t *l;
+	cots_px_t *c;
+        cots_qx_t *v;
+};
+
+static void
+rsmp(cots_ts_t db, cots_to_t ival, cots_to_t from, cots_to_t till)
+{
+	/* the bars series is just for the tsoa */
+	cots_ts_t bs = make_cots_ts("ppppq", 0U);
+	struct bars b;
+	size_t nb = 0U;
+	double vol = 0.;
+	ssize_t n;
+
+	cots_init_tsoa(&b.proto, bs);
+	while ((n = cots_resample(db, ival, from, till, &b.proto)) > 0) {
+		for (ssize_t j = 0; j < n; j++, nb++) {
+			if (nb < 3U) {
+				printf("%lu\t%d\t%d\t%d\t%d\t%d\n",
+				       b.proto.toffs[j],
+				       (int)b.o[j], (int)b.h[j],
+				       (int)b.l[j], (int)b.c[j],
+				       (int)b.v[j]);
+			}
+			vol += (double)b.v[j];
+		}
+	}
+	printf("%zu\t%.0f\n", nb, vol);
+	cots_fini_tsoa(&b.proto, bs);
+	free_cots_ts(bs);
+	return;
+}
+
+int main(void)
+{
+	cots_ts_t db = make_cots_ts("qp", 0U);
+
+	cots_attach(db, "rsmp_01.cots", O_CREAT | O_TRUNC | O_RDWR);
+	for (size_t i = 0U; i < NTICKS; i++) {
+		/* a tick every second, prices going up and down */
+		struct candle t = {
+			{i * 1000000000ULL}, 2.dd,
+			(cots_px_t)(int)(i % 100U < 50U ? i % 100U : 100U - i % 100U)
+		};
+		cots_write_tick(db, &t.proto);
+	}
+	cots_detach(db);
+	free_cots_ts(db);
+
+	db = cots_open_ts("rsmp_01.cots", O_RDONLY);
+	/* minute bars over everything */
+	rsmp(db, 60000000000ULL, 0U, -1ULL);
+	/* 7-second bars off a funny start */
+	rsmp(db, 7000000000ULL, 1500000000ULL, 10000000000000ULL);
+	cots_close_ts(db);
+	return 0;
+}
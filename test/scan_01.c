@@ -0,0 +1,104 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <cotse.h>
+
+#define NTICKS	(50000U)
+
+struct candle {
+    	struct cots_tick_s proto;
+        cots_qx_t q;
+    	cots_px_t p;
+};
+
+struct clo_s {
+	pthread_mutex_t mtx;
+	size_t npg;
+	size_t nbad;
+	size_t seqs;
+	size_t till;
+};
+
+static cots_to_t
+mktoff(size_t i)
+{
+	return i * 1000U + (i * 7919U) % 13U;
+}
+
+static int
+check(const struct cots_tsoa_s *t, size_t nt, size_t seq, void *clo)
+{
+	struct clo_s *c = clo;
+	const cots_qx_t *q = t->cols[0U];
+	size_t nbad = 0U;
+
+	/* pages are 8192 ticks each */
+	for (size_t j = 0U, i = seq * 8192U; j < nt; j++, i++) {
+		nbad += t->toffs[j] != mktoff(i);
+		nbad += q[j] != (cots_qx_t)i;
+	}
+	pthread_mutex_lock(&c->mtx);
+	c->npg++;
+	c->nbad += nbad;
+	c->seqs += seq;
+	pthread_mutex_unlock(&c->mtx);
+	return 0;
+}
+
+static int
+check_till(const struct cots_tsoa_s *t, size_t nt, size_t seq, void *clo)
+{
+/* like check() but stop at page TILL */
+	struct clo_s *c = clo;
+
+	if (seq >= c->till) {
+		return 1;
+	}
+	return check(t, nt, seq, clo);
+}
+
+static void
+scan_till(cots_ts_t db, size_t nth, size_t till)
+{
+	struct clo_s c = {.mtx = PTHREAD_MUTEX_INITIALIZER, .till = till};
+	ssize_t n = cots_scan_parallel(db, nth, check_till, &c);
+
+	printf("%zd\t%zu\t%zu\t%zu\n", n, c.npg, c.seqs, c.nbad);
+	return;
+}
+
+static void
+scan(cots_ts_t db, size_t nth)
+{
+	struct clo_s c = {PTHREAD_MUTEX_INITIALIZER};
+	ssize_t n = cots_scan_parallel(db, nth, check, &c);
+
+	printf("%zd\t%zu\t%zu\t%zu\n", n, c.npg, c.seqs, c.nbad);
+	return;
+}
+
+int main(void)
+{
+	cots_ts_t db = make_cots_ts("qp", 0U);
+
+	cots_attach(db, "scan_01.cots", O_CREAT | O_TRUNC | O_RDWR);
+	for (size_t i = 0U; i < NTICKS; i++) {
+		struct candle t = {{mktoff(i)}, (cots_qx_t)i, 1.df};
+		cots_write_tick(db, &t.proto);
+	}
+	/* unflushed ticks come last */
+	scan(db, 3U);
+	/* stopping at the unflushed ticks doesn't count them */
+	scan_till(db, 3U, 6U);
+	cots_detach(db);
+	free_cots_ts(db);
+
+	db = cots_open_ts("scan_01.cots", O_RDONLY);
+	scan(db, 1U);
+	scan(db, 4U);
+	scan(db, 0U);
+	/* one worker hands out pages in order, page 2 stops the scan */
+	scan_till(db, 1U, 2U);
+	cots_close_ts(db);
+	return 0;
+}
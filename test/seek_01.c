@@ -0,0 +1,77 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <cotse.h>
+
+#define NTICKS	(20000U)
+
+struct candle {
+    	struct cots_tick_s proto;
+        cots_qx_t q;
+    	cots_px_t p;
+};
+
+struct candle_soa {
+    	struct cots_tsoa_s proto;
+        cots_qx_t *q;
+    	cots_px_t *p;
+};
+
+static cots_to_t
+mktoff(size_t i)
+{
+	/* strictly increasing but not equidistant */
+	return i * 1000U + (i * 7919U) % 13U;
+}
+
+static void
+seek(cots_ts_t db, struct candle_soa *c, cots_to_t from)
+{
+	size_t ntot = 0U;
+	ssize_t n;
+
+	if (cots_seek(db, from) < 0) {
+		puts("seek failed");
+		return;
+	}
+	if ((n = cots_read_ticks(&c->proto, db)) > 0) {
+		printf("%lu\t%zd", c->proto.toffs[0U], n);
+		ntot += n;
+	}
+	while ((n = cots_read_ticks(&c->proto, db)) > 0) {
+		ntot += n;
+	}
+	printf("\t%zu\n", ntot);
+	return;
+}
+
+int main(void)
+{
+	cots_ts_t db = make_cots_ts("qp", 0U);
+	struct candle_soa c;
+
+	cots_attach(db, "seek_01.cots", O_CREAT | O_TRUNC | O_RDWR);
+	for (size_t i = 0U; i < NTICKS; i++) {
+		struct candle t = {{mktoff(i)}, 1.dd, 1.df};
+		cots_write_tick(db, &t.proto);
+	}
+	cots_detach(db);
+	free_cots_ts(db);
+
+	db = cots_open_ts("seek_01.cots", O_RDONLY);
+	cots_init_tsoa(&c.proto, db);
+	/* at the very beginning */
+	seek(db, &c, 0U);
+	/* in the middle of the first page */
+	seek(db, &c, mktoff(100U));
+	/* between two ticks */
+	seek(db, &c, mktoff(100U) + 1U);
+	/* first tick of the second page */
+	seek(db, &c, mktoff(8192U));
+	/* last page */
+	seek(db, &c, mktoff(19999U));
+	/* beyond the last tick */
+	seek(db, &c, mktoff(NTICKS));
+	cots_fini_tsoa(&c.proto, db);
+	cots_close_ts(db);
+	return 0;
+}
@@ -0,0 +1,68 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <cotse.h>
+
+#define NTICKS	(30500U)
+
+struct candle {
+	struct cots_tick_s proto;
+	cots_qx_t q;
+	cots_px_t p;
+};
+
+struct candle_soa {
+	struct cots_tsoa_s proto;
+	cots_qx_t *q;
+	cots_px_t *p;
+};
+
+static uint64_t
+hsum(const struct cots_hist_s *h)
+{
+	uint64_t n = 0U;
+
+	for (size_t i = 0U; i < COTS_HISTZ; i++) {
+		n += h->h[i];
+	}
+	return n;
+}
+
+int main(void)
+{
+	cots_ts_t db = make_cots_ts("qp", 1000U);
+	struct cots_stats_s st;
+	struct candle_soa c;
+	uint64_t compz = 0U;
+
+	/* nothing to show unless asked for */
+	printf("%d\n", cots_stats(db, &st));
+	cots_stats_enable(db, 1);
+	cots_attach(db, "stats_01.cots", O_CREAT | O_TRUNC | O_RDWR);
+	for (size_t i = 0U; i < NTICKS; i++) {
+		struct candle t = {{i * 10U}, (cots_qx_t)i, (cots_px_t)i};
+		cots_write_tick(db, &t.proto);
+	}
+	cots_stats(db, &st);
+	printf("%zu\t%zu\t%zu\n", st.nticks, st.npages, st.ncols);
+	for (size_t i = 0U; i < st.ncols; i++) {
+		printf("%zu\t%d\n", (size_t)st.rawz[i],
+		       st.compz[i] > 0U && st.compz[i] < st.rawz[i]);
+		compz += st.compz[i];
+	}
+	printf("%d\n", compz < st.pagez);
+	printf("%zu\t%zu\t%zu\t%d\n",
+	       (size_t)st.flush.n, (size_t)st.comp.n, (size_t)st.write.n,
+	       hsum(&st.flush) == st.flush.n && st.flush.sum > 0U);
+	cots_detach(db);
+	free_cots_ts(db);
+
+	db = cots_open_ts("stats_01.cots", O_RDONLY);
+	cots_stats_enable(db, 1);
+	cots_init_tsoa(&c.proto, db);
+	while (cots_read_ticks(&c.proto, db) > 0);
+	cots_stats(db, &st);
+	printf("%zu\t%zu\n", (size_t)st.dcmp.n, st.npages);
+	cots_fini_tsoa(&c.proto, db);
+	cots_close_ts(db);
+	return 0;
+}
@@ -0,0 +1,40 @@
+#include <stdio.h>
+#include "candle.h"
+
+#define NTICKS	(30000U)
+
+static void
+scan(cots_ts_t db, struct candle_soa *c, size_t from)
+{
+	size_t nbad = 0U;
+	size_t ntot;
+
+	cots_seek(db, from * 10U);
+	ntot = candle_read(db, c, from, &nbad);
+	printf("%zu\t%zu\t%zu\n", from, ntot, nbad);
+	return;
+}
+
+int main(void)
+{
+	cots_ts_t db = make_cots_ts("qp", 1000U);
+	struct candle_soa c;
+
+	cots_attach(db, "uring_01.cots", O_CREAT | O_TRUNC | O_RDWR);
+	candle_write(db, 0U, NTICKS);
+	cots_detach(db);
+	free_cots_ts(db);
+
+	db = cots_open_ts("uring_01.cots", O_RDONLY);
+	/* the ring must be there */
+	printf("%d\n", cots_uring(db, 4U));
+	cots_init_tsoa(&c.proto, db);
+	scan(db, &c, 0U);
+	/* mid-page */
+	scan(db, &c, 12345U);
+	/* back to the start, the ring has to be repositioned */
+	scan(db, &c, 999U);
+	cots_fini_tsoa(&c.proto, db);
+	cots_close_ts(db);
+	return 0;
+}
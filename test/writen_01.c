@@ -0,0 +1,34 @@
+#include <stdio.h>
+#include "candle.h"
+
+#define NTICKS	(30000U)
+#define NBATCH	(777U)
+
+int main(void)
+{
+	cots_ts_t db = make_cots_ts("qp", 1000U);
+	static struct candle b[NBATCH];
+	size_t ntot;
+	size_t nbad = 0U;
+	int rc = 0;
+
+	cots_attach(db, "writen_01.cots", O_CREAT | O_TRUNC | O_RDWR);
+	for (size_t i = 0U; i < NTICKS; i += NBATCH) {
+		const size_t m = NTICKS - i < NBATCH ? NTICKS - i : NBATCH;
+
+		for (size_t j = 0U; j < m; j++) {
+			b[j] = candle(i + j);
+		}
+		rc |= cots_write_ticks(db, &b->proto, m);
+	}
+	/* out of order batches are refused as a whole */
+	b[0U].proto.toff = NTICKS * 10U;
+	b[1U].proto.toff = 0U;
+	printf("%d\n", cots_write_ticks(db, &b->proto, 2U));
+	cots_detach(db);
+	free_cots_ts(db);
+
+	ntot = candle_check("writen_01.cots", &nbad);
+	printf("%d\t%zu\t%zu\n", rc, ntot, nbad);
+	return 0;
+}
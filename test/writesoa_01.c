@@ -0,0 +1,55 @@
+#include <stdio.h>
+#include "candle.h"
+
+#define NTICKS	(30000U)
+#define NHEAD	(500U)
+
+static cots_to_t t[NTICKS];
+static cots_qx_t q[NTICKS];
+static cots_px_t p[NTICKS];
+
+int main(void)
+{
+	cots_ts_t db = make_cots_ts("qp", 1000U);
+	struct candle_soa c = {{t}, q, p};
+	size_t ntot;
+	size_t nbad = 0U;
+	int rc = 0;
+
+	cots_attach(db, "writesoa_01.cots", O_CREAT | O_TRUNC | O_RDWR);
+	for (size_t i = 0U; i < NTICKS; i++) {
+		const struct candle x = candle(i);
+
+		t[i] = x.proto.toff;
+		q[i] = x.q;
+		p[i] = x.p;
+	}
+	/* leave the WAL half full so pages are misaligned */
+	rc |= candle_write(db, 0U, NHEAD);
+	/* out of order tsoas are refused as a whole */
+	printf("%d\n", cots_write_tsoa(db, &c.proto, 2U));
+	c = (struct candle_soa){{t + NHEAD}, q + NHEAD, p + NHEAD};
+	rc |= cots_write_tsoa(db, &c.proto, NTICKS - NHEAD);
+	cots_detach(db);
+	free_cots_ts(db);
+
+	ntot = candle_check("writesoa_01.cots", &nbad);
+	printf("%d\t%zu\t%zu\n", rc, ntot, nbad);
+	/* pages must line up with the index too */
+	db = cots_open_ts("writesoa_01.cots", O_RDONLY);
+	printf("%zd\n", cots_count(db, 0U, NTICKS * 10U));
+	cots_close_ts(db);
+
+	/* series without a file keep the rows in memory till attached */
+	db = make_cots_ts("qp", 1000U);
+	c = (struct candle_soa){{t}, q, p};
+	printf("%d\n", cots_write_tsoa(db, &c.proto, 4U));
+	cots_attach(db, "writesoa_01b.cots", O_CREAT | O_TRUNC | O_RDWR);
+	cots_detach(db);
+	free_cots_ts(db);
+
+	nbad = 0U;
+	ntot = candle_check("writesoa_01b.cots", &nbad);
+	printf("%zu\t%zu\n", ntot, nbad);
+	return 0;
+}